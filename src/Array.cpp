@@ -27,8 +27,76 @@
 #include "JavaToQore.h"
 #include "QoreToJava.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace jni {
 
+//! maximum number of elements transferred with a single region copy; bounds the size of the temporary buffer
+static constexpr jsize PrimitiveChunkSize = 8192;
+
+//! converts a region of a primitive Java array to Qore values using bulk region copies
+template <typename T, typename A>
+static void get_primitive_list(Env& env, A array, jsize offset, jsize len, QoreListNode& l) {
+    // size the list once; elements are then assigned in place
+    l.set(len - 1, QoreValue(), nullptr);
+
+    std::vector<T> buf(std::min(len, PrimitiveChunkSize));
+    for (jsize i = 0; i < len; i += PrimitiveChunkSize) {
+        jsize n = std::min(len - i, PrimitiveChunkSize);
+        env.getArrayRegion(array, offset + i, n, &buf[0]);
+        for (jsize j = 0; j < n; ++j) {
+            l.set(i + j, JavaToQore::convert(buf[j]), nullptr);
+        }
+    }
+}
+
+//! populates a region of a primitive Java array from Qore values using bulk region copies
+template <typename T, typename A, T (*conv)(const QoreValue&)>
+static void set_primitive_array(Env& env, A array, jsize index, const QoreListNode* l, size_t start) {
+    jsize len = l->size() - start;
+    std::vector<T> buf(std::min(len, PrimitiveChunkSize));
+    for (jsize i = 0; i < len; i += PrimitiveChunkSize) {
+        jsize n = std::min(len - i, PrimitiveChunkSize);
+        for (jsize j = 0; j < n; ++j) {
+            buf[j] = conv(l->retrieveEntry(start + i + j));
+        }
+        env.setArrayRegion(array, index + i, n, &buf[0]);
+    }
+}
+
+//! sets all elements of a primitive Java array to the same value using bulk region copies
+template <typename T, typename A>
+static void fill_primitive_array(Env& env, A array, jsize len, T value) {
+    std::vector<T> buf(std::min(len, PrimitiveChunkSize), value);
+    for (jsize i = 0; i < len; i += PrimitiveChunkSize) {
+        jsize n = std::min(len - i, PrimitiveChunkSize);
+        env.setArrayRegion(array, i, n, &buf[0]);
+    }
+}
+
+//! copies the elements of a primitive Java array to a binary value with a single region copy
+template <typename T, typename A>
+static SimpleRefHolder<BinaryNode> get_primitive_binary(Env& env, A array) {
+    SimpleRefHolder<BinaryNode> rv(new BinaryNode);
+
+    jsize len = env.getArrayLength(array);
+    if (len) {
+        rv->preallocate(len * sizeof(T));
+        env.getArrayRegion(array, 0, len, static_cast<T*>(const_cast<void*>(rv->getPtr())));
+    }
+    return rv;
+}
+
+//! throws an exception if the given range is not within an array of the given length
+static void check_range(jsize size, int64 start, int64 len) {
+    if (start < 0 || len < 0 || start > size || len > size - start) {
+        QoreStringMaker desc("the range starting at index " QLLD " with length " QLLD " is out of bounds for an "
+            "array of length %d", start, len, size);
+        throw BasicException(desc.c_str());
+    }
+}
+
 Array::Array(jclass ecls, int size) {
     LocalReference<jclass> cls(ecls);
     if (size < 1) {
@@ -80,11 +148,7 @@ SimpleRefHolder<BinaryNode> Array::getBinary(Env& env, jarray array) {
 
     jsize size = env.getArrayLength(array);
     rv->preallocate(size);
-
-    for (jsize i = 0; i < size; ++i) {
-        jbyte byte = env.getByteArrayElement(static_cast<jbyteArray>(array), i);
-        reinterpret_cast<jbyte*>(const_cast<void*>(rv->getPtr()))[i] = byte;
-    }
+    env.getBytes(static_cast<jbyteArray>(array), const_cast<void*>(rv->getPtr()), size);
     return rv;
 }
 
@@ -103,11 +167,22 @@ void Array::getList(ReferenceHolder<>& return_value, Env& env, jarray array, jcl
     ReferenceHolder<QoreListNode> l(new QoreListNode(autoTypeInfo), &xsink);
 
     jsize e = env.getArrayLength(array);
+    if (elementType != Type::Reference) {
+        if (e) {
+            getPrimitiveList(**l, env, array, elementType, e);
+        }
+        return_value = l.release();
+        return;
+    }
+
     bool fix_varargs = false;
     if (e > 0 && varargs) {
         fix_varargs = true;
     }
+    // local references for each element are freed in bulk when the frame is recycled
+    Env::LocalFrame frame(env);
     for (jsize i = 0; i < e; ++i) {
+        frame.next();
         QoreValue v = get(env, array, elementType, elementClass, i, pgm, compat_types);
         if (fix_varargs && i == (e - 1) && v.getType() == NT_LIST) {
             ListIterator li(v.get<QoreListNode>());
@@ -123,6 +198,92 @@ void Array::getList(ReferenceHolder<>& return_value, Env& env, jarray array, jcl
     return_value = l.release();
 }
 
+void Array::getPrimitiveList(QoreListNode& l, Env& env, jarray array, Type elementType, jsize len,
+        jsize offset) {
+    assert(len > 0);
+    switch (elementType) {
+        case Type::Boolean:
+            get_primitive_list<jboolean>(env, static_cast<jbooleanArray>(array), offset, len, l);
+            break;
+        case Type::Byte:
+            get_primitive_list<jbyte>(env, static_cast<jbyteArray>(array), offset, len, l);
+            break;
+        case Type::Char:
+            get_primitive_list<jchar>(env, static_cast<jcharArray>(array), offset, len, l);
+            break;
+        case Type::Short:
+            get_primitive_list<jshort>(env, static_cast<jshortArray>(array), offset, len, l);
+            break;
+        case Type::Int:
+            get_primitive_list<jint>(env, static_cast<jintArray>(array), offset, len, l);
+            break;
+        case Type::Long:
+            get_primitive_list<jlong>(env, static_cast<jlongArray>(array), offset, len, l);
+            break;
+        case Type::Float:
+            get_primitive_list<jfloat>(env, static_cast<jfloatArray>(array), offset, len, l);
+            break;
+        case Type::Double:
+            get_primitive_list<jdouble>(env, static_cast<jdoubleArray>(array), offset, len, l);
+            break;
+        default:
+            assert(false);
+    }
+}
+
+void Array::setElements(Env& env, jarray array, Type elementType, jclass elementClass, jsize index,
+        const QoreListNode* l, size_t start, JniExternalProgramData* jpc) {
+    assert(start <= l->size());
+    switch (elementType) {
+        case Type::Boolean:
+            set_primitive_array<jboolean, jbooleanArray, QoreToJava::toBoolean>(env,
+                static_cast<jbooleanArray>(array), index, l, start);
+            break;
+        case Type::Byte:
+            set_primitive_array<jbyte, jbyteArray, QoreToJava::toByte>(env, static_cast<jbyteArray>(array), index,
+                l, start);
+            break;
+        case Type::Char:
+            set_primitive_array<jchar, jcharArray, QoreToJava::toChar>(env, static_cast<jcharArray>(array), index,
+                l, start);
+            break;
+        case Type::Short:
+            set_primitive_array<jshort, jshortArray, QoreToJava::toShort>(env, static_cast<jshortArray>(array),
+                index, l, start);
+            break;
+        case Type::Int:
+            set_primitive_array<jint, jintArray, QoreToJava::toInt>(env, static_cast<jintArray>(array), index, l,
+                start);
+            break;
+        case Type::Long:
+            set_primitive_array<jlong, jlongArray, QoreToJava::toLong>(env, static_cast<jlongArray>(array), index,
+                l, start);
+            break;
+        case Type::Float:
+            set_primitive_array<jfloat, jfloatArray, QoreToJava::toFloat>(env, static_cast<jfloatArray>(array),
+                index, l, start);
+            break;
+        case Type::Double:
+            set_primitive_array<jdouble, jdoubleArray, QoreToJava::toDouble>(env,
+                static_cast<jdoubleArray>(array), index, l, start);
+            break;
+        case Type::Reference:
+        default:
+            assert(elementType == Type::Reference);
+            {
+                // element references are left to the frame and freed in bulk when it is recycled
+                Env::LocalFrame frame(env);
+                TargetKind kind = Globals::getTargetKind(elementClass);
+                for (size_t i = start, e = l->size(); i != e; ++i) {
+                    frame.next();
+                    env.setObjectArrayElement(static_cast<jobjectArray>(array), index + (i - start),
+                        QoreToJava::toObject(l->retrieveEntry(i), elementClass, kind, jpc));
+                }
+            }
+            break;
+    }
+}
+
 QoreValue Array::get(Env& env, jarray array, Type elementType, jclass elementClass, int64 index, QoreProgram* pgm,
         bool compat_types) {
     switch (elementType) {
@@ -159,6 +320,135 @@ void Array::set(int64 index, const QoreValue &value, JniExternalProgramData* jpc
     set(jobj.cast<jarray>(), elementType, elementClass, index, value, jpc);
 }
 
+QoreListNode* Array::getRange(int64 start, int64 len, QoreProgram* pgm, bool compat_types) const {
+    Env env;
+    jarray array = jobj.cast<jarray>();
+    check_range(env.getArrayLength(array), start, len);
+
+    ExceptionSink xsink;
+    ReferenceHolder<QoreListNode> l(new QoreListNode(autoTypeInfo), &xsink);
+    if (!len) {
+        return l.release();
+    }
+
+    if (elementType != Type::Reference) {
+        getPrimitiveList(**l, env, array, elementType, len, start);
+        return l.release();
+    }
+
+    // local references for each element are freed in bulk when the frame is recycled
+    Env::LocalFrame frame(env);
+    for (jsize i = start, e = start + len; i < e; ++i) {
+        frame.next();
+        l->push(JavaToQore::convertToQore(env.getObjectArrayElement(static_cast<jobjectArray>(array), i), pgm,
+            compat_types), nullptr);
+    }
+    return l.release();
+}
+
+void Array::setRange(int64 start, const QoreListNode* l, JniExternalProgramData* jpc) {
+    Env env;
+    jarray array = jobj.cast<jarray>();
+    check_range(env.getArrayLength(array), start, l->size());
+    if (l->empty()) {
+        return;
+    }
+    setElements(env, array, elementType, elementClass, start, l, 0, jpc);
+}
+
+void Array::setRange(int64 start, const BinaryNode& b) {
+    if (elementType != Type::Byte) {
+        throw BasicException("binary values can only be copied to byte arrays");
+    }
+
+    Env env;
+    jbyteArray array = jobj.cast<jbyteArray>();
+    check_range(env.getArrayLength(array), start, b.size());
+    if (b.size()) {
+        env.setArrayRegion(array, start, b.size(), static_cast<const jbyte*>(b.getPtr()));
+    }
+}
+
+void Array::fill(const QoreValue& value, JniExternalProgramData* jpc) {
+    Env env;
+    jarray array = jobj.cast<jarray>();
+    jsize len = env.getArrayLength(array);
+
+    switch (elementType) {
+        case Type::Boolean:
+            fill_primitive_array(env, static_cast<jbooleanArray>(array), len, QoreToJava::toBoolean(value));
+            break;
+        case Type::Byte:
+            fill_primitive_array(env, static_cast<jbyteArray>(array), len, QoreToJava::toByte(value));
+            break;
+        case Type::Char:
+            fill_primitive_array(env, static_cast<jcharArray>(array), len, QoreToJava::toChar(value));
+            break;
+        case Type::Short:
+            fill_primitive_array(env, static_cast<jshortArray>(array), len, QoreToJava::toShort(value));
+            break;
+        case Type::Int:
+            fill_primitive_array(env, static_cast<jintArray>(array), len, QoreToJava::toInt(value));
+            break;
+        case Type::Long:
+            fill_primitive_array(env, static_cast<jlongArray>(array), len, QoreToJava::toLong(value));
+            break;
+        case Type::Float:
+            fill_primitive_array(env, static_cast<jfloatArray>(array), len, QoreToJava::toFloat(value));
+            break;
+        case Type::Double:
+            fill_primitive_array(env, static_cast<jdoubleArray>(array), len, QoreToJava::toDouble(value));
+            break;
+        case Type::Reference:
+        default: {
+            assert(elementType == Type::Reference);
+            // the value is converted once and stored in all elements with a single call
+            LocalReference<jobject> v = QoreToJava::toObject(value, elementClass, jpc);
+            jvalue jargs[2];
+            jargs[0].l = array;
+            jargs[1].l = v;
+            env.callStaticVoidMethod(Globals::classArrays, Globals::methodArraysFill, jargs);
+            break;
+        }
+    }
+}
+
+SimpleRefHolder<BinaryNode> Array::toBinary() const {
+    Env env;
+    jarray array = jobj.cast<jarray>();
+
+    switch (elementType) {
+        case Type::Boolean: return get_primitive_binary<jboolean>(env, static_cast<jbooleanArray>(array));
+        case Type::Byte: return getBinary(env, array);
+        case Type::Char: return get_primitive_binary<jchar>(env, static_cast<jcharArray>(array));
+        case Type::Short: return get_primitive_binary<jshort>(env, static_cast<jshortArray>(array));
+        case Type::Int: return get_primitive_binary<jint>(env, static_cast<jintArray>(array));
+        case Type::Long: return get_primitive_binary<jlong>(env, static_cast<jlongArray>(array));
+        case Type::Float: return get_primitive_binary<jfloat>(env, static_cast<jfloatArray>(array));
+        case Type::Double: return get_primitive_binary<jdouble>(env, static_cast<jdoubleArray>(array));
+        case Type::Reference:
+        default:
+            assert(elementType == Type::Reference);
+            throw BasicException("only arrays of primitive types can be converted to binary values");
+    }
+}
+
+void Array::copyFrom(const Array& src, int64 start) {
+    Env env;
+    jarray array = jobj.cast<jarray>();
+    jarray srcArray = src.jobj.cast<jarray>();
+    jsize len = env.getArrayLength(srcArray);
+    check_range(env.getArrayLength(array), start, len);
+
+    jvalue jargs[5];
+    jargs[0].l = srcArray;
+    jargs[1].i = 0;
+    jargs[2].l = array;
+    jargs[3].i = start;
+    jargs[4].i = len;
+    env.callStaticVoidMethod(Globals::classSystem, Globals::methodSystemArraycopy, jargs);
+}
+
 QoreStringNodeHolder Array::deepToString() const {
     Env env;
     return deepToString(env, jobj.cast<jarray>());
@@ -240,52 +530,53 @@ LocalReference<jclass> Array::getClassForValue(QoreValue v, JniExternalProgramDa
     throw BasicException(desc.c_str());
 }
 
-LocalReference<jarray> Array::toObjectArray(const QoreListNode* l, jclass elementClass, size_t start,
-        JniExternalProgramData* jpc) {
+LocalReference<jarray> Array::toObjectArray(const QoreListNode* l, jclass elementClass, Type elementType,
+        size_t start, JniExternalProgramData* jpc) {
     assert(start < l->size());
-    Type elementType = Globals::getType(elementClass);
 
     LocalReference<jarray> jarray = getNew(elementType, elementClass, l->size() - start);
-    for (unsigned i = start, e = l->size(); i != e; ++i) {
-        set(jarray, elementType, elementClass, i - start, l->retrieveEntry(i), jpc);
-    }
+    Env env;
+    setAll(env, jarray, elementType, elementClass, l, start, jpc);
 
     return jarray.release();
 }
 
-LocalReference<jarray> Array::toJava(const QoreListNode* l, size_t start, JniExternalProgramData* jpc) {
-    if (l->size() <= start)
-        return nullptr;
-
-    LocalReference<jclass> elementClass = nullptr;
+QoreValue Array::getFirstElement(const QoreListNode* l, size_t start, bool& mixed) {
+    mixed = false;
+    QoreValue rv;
     // to determine the common type, we need a typeInfo object
     // because each local reference is a separate ptr
     const QoreTypeInfo* typeInfo = nullptr;
 
     // check list to see if we have a unique type
-    for (unsigned i = start, e = l->size(); i != e; ++i) {
-        // get this element's target Java class
+    for (size_t i = start, e = l->size(); i != e; ++i) {
         QoreValue v = l->retrieveEntry(i);
         if (v.isNullOrNothing())
             continue;
 
-        if (!elementClass) {
-            elementClass = getClassForValue(v, jpc);
-            if (!elementClass) {
-                typeInfo = autoTypeInfo;
-            } else {
-                typeInfo = v.getTypeInfo();
-            }
-        } else {
-            const QoreTypeInfo* newTypeInfo = v.getTypeInfo();
-            if (newTypeInfo != typeInfo) {
-                elementClass = Globals::classObject.toLocal();
-                break;
-            }
+        if (rv.isNothing()) {
+            rv = v;
+            typeInfo = v.getTypeInfo();
+        } else if (v.getTypeInfo() != typeInfo) {
+            mixed = true;
+            break;
         }
     }
+    return rv;
+}
 
-    if (!elementClass) {
+LocalReference<jarray> Array::toJava(const QoreListNode* l, size_t start, JniExternalProgramData* jpc) {
+    if (l->size() <= start)
+        return nullptr;
+
+    bool mixed;
+    QoreValue v = getFirstElement(l, start, mixed);
+    LocalReference<jclass> elementClass = nullptr;
+    if (!v.isNothing()) {
+        // get the first element's target Java class; this raises an exception for unsupported types
+        elementClass = getClassForValue(v, jpc);
+    }
+    if (!elementClass || mixed) {
         elementClass = Globals::classObject.toLocal();
     }
 
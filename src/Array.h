@@ -73,6 +73,58 @@ class Array : public QoreJniPrivateData {
     DLLLOCAL void set(int64 index, const QoreValue &value, JniExternalProgramData* jpc = nullptr);
     DLLLOCAL QoreStringNodeHolder deepToString() const;
 
+    /**
+     * \brief Converts a range of elements to a list; primitive arrays are read with bulk region copies.
+     * \param start the index of the first element
+     * \param len the number of elements
+     * \param pgm the program for converting objects
+     * \param compat_types the compatible type conversion flag
+     * \return a new list of converted elements
+     * \throws BasicException if the range is out of bounds
+     */
+    DLLLOCAL QoreListNode* getRange(int64 start, int64 len, QoreProgram* pgm, bool compat_types) const;
+
+    /**
+     * \brief Sets consecutive elements from a list; primitive arrays are written with bulk region copies.
+     * \param start the index of the first element to set
+     * \param l the values of the elements
+     * \param jpc the program context for converting Qore objects, if any
+     * \throws BasicException if the range is out of bounds
+     */
+    DLLLOCAL void setRange(int64 start, const QoreListNode* l, JniExternalProgramData* jpc = nullptr);
+
+    /**
+     * \brief Copies a binary value to consecutive elements of a byte array with a single region copy.
+     * \param start the index of the first element to set
+     * \param b the source data
+     * \throws BasicException if the array is not a byte array or the range is out of bounds
+     */
+    DLLLOCAL void setRange(int64 start, const BinaryNode& b);
+
+    /**
+     * \brief Sets all elements to the given value; the value is converted only once.
+     * \param value the value to set
+     * \param jpc the program context for converting Qore objects, if any
+     */
+    DLLLOCAL void fill(const QoreValue& value, JniExternalProgramData* jpc = nullptr);
+
+    /**
+     * \brief Returns the memory of a primitive array as a binary value.
+     *
+     * Elements wider than one byte are copied in native byte order.
+     * \throws BasicException if the array is not an array of a primitive type
+     */
+    DLLLOCAL SimpleRefHolder<BinaryNode> toBinary() const;
+
+    /**
+     * \brief Copies all elements of another array with a single call to System.arraycopy().
+     * \param src the source array
+     * \param start the index in this array where the first element is stored
+     * \throws BasicException if the elements do not fit
+     * \throws JavaException if the element types are incompatible
+     */
+    DLLLOCAL void copyFrom(const Array& src, int64 start);
+
     DLLLOCAL static void getArgList(ReferenceHolder<QoreListNode>& return_value, Env& env, jarray array,
             QoreProgram* pgm, bool varargs = false);
 
@@ -87,15 +139,76 @@ class Array : public QoreJniPrivateData {
     DLLLOCAL static QoreValue get(Env& env, jarray array, Type elementType, jclass elementClass, int64 index,
             QoreProgram* pgm, bool compat_types);
 
+    /**
+     * \brief Converts all elements of a primitive array to Qore values with bulk region copies.
+     * \param l the list to populate
+     * \param env the JNI environment
+     * \param array the primitive array
+     * \param elementType the primitive element type of the array; must not be Type::Reference
+     * \param len the number of elements to convert; must be greater than 0
+     * \param offset the index of the first element to convert
+     * \throws JavaException if the array cannot be read
+     */
+    DLLLOCAL static void getPrimitiveList(QoreListNode& l, Env& env, jarray array, Type elementType, jsize len,
+            jsize offset = 0);
+
+    /**
+     * \brief Populates an array from a Qore list starting at the given list offset.
+     *
+     * Primitive arrays are populated with bulk region copies.
+     * \param env the JNI environment
+     * \param array the array; must have at least l->size() - start elements
+     * \param elementType the element type of the array
+     * \param elementClass the element class of the array
+     * \param l the source list
+     * \param start the offset in the list of the first element to convert
+     * \param jpc the program context for converting Qore objects, if any
+     * \throws Exception if any element cannot be converted or the array cannot be written
+     */
+    DLLLOCAL static void setAll(Env& env, jarray array, Type elementType, jclass elementClass,
+            const QoreListNode* l, size_t start = 0, JniExternalProgramData* jpc = nullptr) {
+        setElements(env, array, elementType, elementClass, 0, l, start, jpc);
+    }
+
+    /**
+     * \brief Populates consecutive array elements from a Qore list starting at the given list offset.
+     * \param env the JNI environment
+     * \param array the array; must have at least index + l->size() - start elements
+     * \param elementType the element type of the array
+     * \param elementClass the element class of the array
+     * \param index the index of the first array element to set
+     * \param l the source list
+     * \param start the offset in the list of the first element to convert
+     * \param jpc the program context for converting Qore objects, if any
+     * \throws Exception if any element cannot be converted or the array cannot be written
+     */
+    DLLLOCAL static void setElements(Env& env, jarray array, Type elementType, jclass elementClass, jsize index,
+            const QoreListNode* l, size_t start, JniExternalProgramData* jpc);
+
     DLLLOCAL static LocalReference<jarray> getNew(Type elementType, jclass elementClass, jsize size);
 
     DLLLOCAL static LocalReference<jarray> toJava(const QoreListNode* l, size_t start = 0,
             JniExternalProgramData* jpc = nullptr);
     DLLLOCAL static LocalReference<jarray> toObjectArray(const QoreListNode* l, jclass elementClass, size_t start = 0,
-            JniExternalProgramData* jpc = nullptr);
+            JniExternalProgramData* jpc = nullptr) {
+        return toObjectArray(l, elementClass, Globals::getType(elementClass), start, jpc);
+    }
+    //! Creates an array of the given element class and type from a list; for callers that know the element type
+    DLLLOCAL static LocalReference<jarray> toObjectArray(const QoreListNode* l, jclass elementClass,
+            Type elementType, size_t start, JniExternalProgramData* jpc);
 
     DLLLOCAL static LocalReference<jclass> getClassForValue(QoreValue v, JniExternalProgramData* jpc = nullptr);
 
+    //! Returns the first non-null element of the list, which determines the element class used by toJava()
+    /** @param l the list
+        @param start the index of the first element to check
+        @param mixed set to true if another non-null element has a different type; toJava() then creates an
+        \c Object[]
+
+        @return the first non-null element or NOTHING if the list has no non-null elements
+    */
+    DLLLOCAL static QoreValue getFirstElement(const QoreListNode* l, size_t start, bool& mixed);
+
     DLLLOCAL static SimpleRefHolder<BinaryNode> getBinary(Env& env, jarray array);
 
 private:
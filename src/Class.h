@@ -33,6 +33,7 @@
 
 #include <qore/Qore.h>
 
+#include <atomic>
 #include <vector>
 
 #include "LocalReference.h"
@@ -99,6 +100,34 @@ public:
 
     DLLLOCAL void trackMethod(BaseMethod* m);
 
+    //! returns true if the Qore class wrapping this class has been completely populated with methods and members
+    /** can be called without the class map lock held
+    */
+    DLLLOCAL bool isPopulated() const {
+        return populated.load(std::memory_order_acquire);
+    }
+
+    //! marks the Qore class wrapping this class as completely populated
+    /** must be called with the class map lock held after all methods and members have been added
+    */
+    DLLLOCAL void setPopulated() {
+        populated.store(true, std::memory_order_release);
+    }
+
+    //! returns true if population of the Qore class wrapping this class has been started
+    /** must be called with the class map lock held
+    */
+    DLLLOCAL bool isPopulating() const {
+        return populating;
+    }
+
+    //! marks the Qore class wrapping this class as being populated
+    /** must be called with the class map lock held
+    */
+    DLLLOCAL void setPopulating() {
+        populating = true;
+    }
+
     // returns a local reference to the jclass
     DLLLOCAL jclass toLocal() {
         return cls.toLocal();
@@ -109,6 +138,10 @@ private:
     // for tracking Method objects associated with this Class
     typedef std::vector<BaseMethod*> mlist_t;
     mlist_t mlist;
+    // set when the Qore class wrapping this class has been completely populated
+    std::atomic<bool> populated{false};
+    // set when population of the Qore class wrapping this class has been started; protected by the class map lock
+    bool populating = false;
 };
 
 } // namespace jni
@@ -0,0 +1,242 @@
+//--------------------------------------------------------------------*- C++ -*-
+//
+//  Qore Programming Language
+//
+//  Copyright (C) 2016 - 2021 Qore Technologies, s.r.o.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//------------------------------------------------------------------------------
+#include "CollectionView.h"
+#include "Globals.h"
+#include "JavaToQore.h"
+#include "QoreJniClassMap.h"
+#include "StringTranscoder.h"
+
+namespace jni {
+
+MapView::~MapView() {
+    ExceptionSink xsink;
+    cache->deref(&xsink);
+}
+
+int64 MapView::size() const {
+    Env env;
+    return env.callIntMethod(jobj, Globals::methodMapSize, nullptr);
+}
+
+bool MapView::hasKey(const char* key) const {
+    // the Java map is always checked; a cached value could answer true, but missing keys and null values are not
+    // cached, so a cache miss proves nothing
+    Env env;
+    LocalReference<jstring> jkey = StringTranscoder::toJava(env, key, strlen(key));
+    jvalue jarg;
+    jarg.l = jkey;
+    return env.callBooleanMethod(jobj, Globals::methodMapContainsKey, &jarg);
+}
+
+QoreValue MapView::get(const char* key, QoreProgram* pgm) {
+    {
+        AutoLocker al(lock);
+        bool exists;
+        QoreValue v = cache->getKeyValueExistence(key, exists);
+        if (exists) {
+            return v.refSelf();
+        }
+    }
+
+    // the value is converted without holding the lock
+    Env env;
+    LocalReference<jstring> jkey = StringTranscoder::toJava(env, key, strlen(key));
+    jvalue jarg;
+    jarg.l = jkey;
+    LocalReference<jobject> jval = env.callObjectMethod(jobj, Globals::methodMapGet, &jarg);
+    // null values are not cached, so that keys added to the Java map later are found
+    if (!jval) {
+        return QoreValue();
+    }
+    return setCached(key, JavaToQore::convertToQore(std::move(jval), pgm, JniExternalProgramData::compatTypes()));
+}
+
+QoreValue MapView::setCached(const char* key, QoreValue val) {
+    ExceptionSink xsink;
+    ValueHolder holder(val, &xsink);
+
+    AutoLocker al(lock);
+    bool exists;
+    QoreValue v = cache->getKeyValueExistence(key, exists);
+    if (!exists) {
+        v = holder.release();
+        cache->setKeyValue(key, v, &xsink);
+        if (xsink) {
+            throw XsinkException(xsink);
+        }
+    }
+    return v.refSelf();
+}
+
+LocalReference<jobjectArray> MapView::getEntries(Env& env) const {
+    jvalue jarg;
+    jarg.l = jobj;
+    LocalReference<jobjectArray> entries = env.callStaticObjectMethod(Globals::classQoreJavaApi,
+        Globals::methodQoreJavaApiFlattenMap, &jarg).as<jobjectArray>();
+    if (!entries) {
+        throw BasicException("cannot convert a java.util.Map with null or non-string keys to a hash");
+    }
+    return entries;
+}
+
+QoreListNode* MapView::keys() const {
+    Env env;
+    LocalReference<jobjectArray> entries = getEntries(env);
+    jsize size = env.getArrayLength(entries);
+
+    ExceptionSink xsink;
+    ReferenceHolder<QoreListNode> rv(new QoreListNode(stringTypeInfo), &xsink);
+    // local references for each key are freed in bulk when the frame is recycled
+    Env::LocalFrame frame(env);
+    for (jsize i = 0; i < size; i += 2) {
+        frame.next();
+        LocalReference<jstring> key = env.getObjectArrayElement(entries, i).as<jstring>();
+        rv->push(StringTranscoder::toQore(env, key), nullptr);
+    }
+    return rv.release();
+}
+
+QoreHashNode* MapView::toHash(QoreProgram* pgm) {
+    Env env;
+    LocalReference<jobjectArray> entries = getEntries(env);
+    jsize size = env.getArrayLength(entries);
+
+    ExceptionSink xsink;
+    ReferenceHolder<QoreHashNode> rv(new QoreHashNode(autoTypeInfo), &xsink);
+    {
+        // local references for each entry are freed in bulk when the frame is recycled
+        Env::LocalFrame frame(env);
+        for (jsize i = 0; i < size; i += 2) {
+            frame.next();
+            LocalReference<jstring> key = env.getObjectArrayElement(entries, i).as<jstring>();
+            SimpleRefHolder<QoreStringNode> key_str(StringTranscoder::toQore(env, key));
+
+            QoreValue val;
+            bool exists;
+            {
+                AutoLocker al(lock);
+                val = cache->getKeyValueExistence(key_str->c_str(), exists);
+                if (exists) {
+                    val.refSelf();
+                }
+            }
+            if (!exists) {
+                val = setCached(key_str->c_str(), JavaToQore::convertToQore(env.getObjectArrayElement(entries, i + 1),
+                    pgm, JniExternalProgramData::compatTypes()));
+            }
+
+            rv->setKeyValue(key_str->c_str(), val, &xsink);
+            if (xsink) {
+                throw XsinkException(xsink);
+            }
+        }
+    }
+    return rv.release();
+}
+
+ListView::~ListView() {
+    ExceptionSink xsink;
+    for (QoreValue& v : cache) {
+        v.discard(&xsink);
+    }
+}
+
+int64 ListView::size() const {
+    Env env;
+    return env.callIntMethod(jobj, Globals::methodListSize, nullptr);
+}
+
+QoreValue ListView::get(int64 index, QoreProgram* pgm) {
+    if (index >= 0) {
+        AutoLocker al(lock);
+        if (static_cast<size_t>(index) < converted.size() && converted[index]) {
+            return cache[index].refSelf();
+        }
+    }
+
+    // the element is converted without holding the lock; List.get() raises an exception for invalid indexes
+    Env env;
+    jvalue jarg;
+    jarg.i = static_cast<jint>(index);
+    if (jarg.i != index) {
+        QoreStringMaker desc("list index " QLLD " is out of range", index);
+        throw BasicException(desc.c_str());
+    }
+    QoreValue val = JavaToQore::convertToQore(env.callObjectMethod(jobj, Globals::methodListGet, &jarg), pgm,
+        JniExternalProgramData::compatTypes());
+    return setCached(index, val);
+}
+
+QoreValue ListView::setCached(size_t index, QoreValue val) {
+    AutoLocker al(lock);
+    if (index >= converted.size()) {
+        converted.resize(index + 1);
+        cache.resize(index + 1);
+    }
+    if (converted[index]) {
+        ExceptionSink xsink;
+        val.discard(&xsink);
+    } else {
+        cache[index] = val;
+        converted[index] = true;
+    }
+    return cache[index].refSelf();
+}
+
+QoreListNode* ListView::toList(QoreProgram* pgm) {
+    Env env;
+    // List.toArray() copies the elements in one call
+    LocalReference<jobjectArray> elements = env.callObjectMethod(jobj, Globals::methodListToArray,
+        nullptr).as<jobjectArray>();
+    jsize size = elements ? env.getArrayLength(elements) : 0;
+
+    ExceptionSink xsink;
+    ReferenceHolder<QoreListNode> rv(new QoreListNode(autoTypeInfo), &xsink);
+    {
+        // local references for each element are freed in bulk when the frame is recycled
+        Env::LocalFrame frame(env);
+        for (jsize i = 0; i < size; ++i) {
+            frame.next();
+            QoreValue val;
+            bool found = false;
+            {
+                AutoLocker al(lock);
+                if (static_cast<size_t>(i) < converted.size() && converted[i]) {
+                    val = cache[i].refSelf();
+                    found = true;
+                }
+            }
+            if (!found) {
+                val = setCached(i, JavaToQore::convertToQore(env.getObjectArrayElement(elements, i), pgm,
+                    JniExternalProgramData::compatTypes()));
+            }
+            rv->push(val, nullptr);
+        }
+    }
+    return rv.release();
+}
+
+} // namespace jni
@@ -0,0 +1,159 @@
+//--------------------------------------------------------------------*- C++ -*-
+//
+//  Qore Programming Language
+//
+//  Copyright (C) 2016 - 2021 Qore Technologies, s.r.o.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//------------------------------------------------------------------------------
+///
+/// \file
+/// \brief Defines lazy Qore views of Java collections.
+///
+//------------------------------------------------------------------------------
+#ifndef QORE_JNI_COLLECTIONVIEW_H_
+#define QORE_JNI_COLLECTIONVIEW_H_
+
+#include <qore/Qore.h>
+
+#include <vector>
+
+#include "QoreJniPrivateData.h"
+#include "Env.h"
+
+extern QoreClass* QC_JAVAMAPVIEW;
+extern qore_classid_t CID_JAVAMAPVIEW;
+extern QoreClass* QC_JAVALISTVIEW;
+extern qore_classid_t CID_JAVALISTVIEW;
+
+namespace jni {
+
+/**
+ * \brief A lazy view of a java.util.Map object.
+ *
+ * Values are converted to Qore only when they are accessed; converted values are cached, so changes to the Java map
+ * made after a value has been accessed are not visible through the view.  Missing keys and null values are not
+ * cached.
+ */
+class MapView : public QoreJniPrivateData {
+public:
+    /**
+     * \brief Constructor.
+     * \param map a local reference to the java.util.Map object
+     * \throws JavaException if a global reference cannot be created
+     */
+    DLLLOCAL MapView(jobject map) : QoreJniPrivateData(map) {
+    }
+
+    //! Returns the number of entries in the map
+    DLLLOCAL int64 size() const;
+
+    //! Returns true if the map contains the given key
+    DLLLOCAL bool hasKey(const char* key) const;
+
+    /**
+     * \brief Returns the value for the given key; the value is converted on the first access.
+     * \param key the key
+     * \param pgm the program for converting objects
+     * \return the converted value; the caller owns the reference
+     */
+    DLLLOCAL QoreValue get(const char* key, QoreProgram* pgm);
+
+    /**
+     * \brief Returns all keys of the map.
+     * \throws BasicException if any key is not a string
+     */
+    DLLLOCAL QoreListNode* keys() const;
+
+    /**
+     * \brief Converts the entire map to a hash; values already converted are taken from the cache.
+     * \param pgm the program for converting objects
+     * \throws BasicException if any key is not a string
+     */
+    DLLLOCAL QoreHashNode* toHash(QoreProgram* pgm);
+
+protected:
+    DLLLOCAL virtual ~MapView();
+
+private:
+    //! protects the cache
+    mutable QoreThreadLock lock;
+    //! converted values
+    QoreHashNode* cache = new QoreHashNode(autoTypeInfo);
+
+    //! returns the keys and values of the map as a flat array or nullptr if any key is not a string
+    DLLLOCAL LocalReference<jobjectArray> getEntries(Env& env) const;
+
+    //! stores a converted value in the cache unless another thread has already stored one and returns the result
+    DLLLOCAL QoreValue setCached(const char* key, QoreValue val);
+};
+
+/**
+ * \brief A lazy view of a java.util.List object.
+ *
+ * Elements are converted to Qore only when they are accessed; converted elements are cached, so changes to the
+ * Java list made after an element has been accessed are not visible through the view.
+ */
+class ListView : public QoreJniPrivateData {
+public:
+    /**
+     * \brief Constructor.
+     * \param list a local reference to the java.util.List object
+     * \throws JavaException if a global reference cannot be created
+     */
+    DLLLOCAL ListView(jobject list) : QoreJniPrivateData(list) {
+    }
+
+    //! Returns the number of elements in the list
+    DLLLOCAL int64 size() const;
+
+    /**
+     * \brief Returns the element at the given index; the element is converted on the first access.
+     * \param index the 0-based index of the element
+     * \param pgm the program for converting objects
+     * \return the converted value; the caller owns the reference
+     * \throws JavaException if the index is out of bounds
+     */
+    DLLLOCAL QoreValue get(int64 index, QoreProgram* pgm);
+
+    /**
+     * \brief Converts the entire list; elements already converted are taken from the cache.
+     * \param pgm the program for converting objects
+     */
+    DLLLOCAL QoreListNode* toList(QoreProgram* pgm);
+
+protected:
+    DLLLOCAL virtual ~ListView();
+
+private:
+    //! protects the cache
+    mutable QoreThreadLock lock;
+    //! converted elements
+    std::vector<QoreValue> cache;
+    //! flags for converted elements
+    std::vector<bool> converted;
+
+    //! stores a converted element in the cache unless another thread has already stored one and returns the result
+    DLLLOCAL QoreValue setCached(size_t index, QoreValue val);
+};
+
+} // namespace jni
+
+#endif // QORE_JNI_COLLECTIONVIEW_H_
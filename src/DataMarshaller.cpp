@@ -0,0 +1,365 @@
+//--------------------------------------------------------------------*- C++ -*-
+//
+//  Qore Programming Language
+//
+//  Copyright (C) 2016 - 2021 Qore Technologies, s.r.o.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//------------------------------------------------------------------------------
+#include "DataMarshaller.h"
+#include "Array.h"
+#include "Globals.h"
+#include "NumberConverter.h"
+#include "QoreJniClassMap.h"
+#include "QoreToJava.h"
+
+#include <climits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace jni {
+
+namespace {
+// value tags; must match org.qore.jni.QoreDataDecoder
+enum : unsigned char {
+    T_NULL = 0,
+    T_TRUE = 1,
+    T_FALSE = 2,
+    T_INT = 3,
+    T_FLOAT = 4,
+    T_STRING = 5,
+    T_BINARY = 6,
+    T_DATE = 7,
+    T_NUMBER = 8,
+    T_HASH = 9,
+    T_LIST = 10,
+    T_OBJECT = 11,
+};
+
+// list element classes; must match org.qore.jni.QoreDataDecoder
+enum : unsigned char {
+    E_OBJECT = 0,
+    E_LONG = 1,
+    E_DOUBLE = 2,
+    E_BOOLEAN = 3,
+    E_STRING = 4,
+    E_NUMBER = 5,
+    E_HASH = 6,
+    E_CLASS = 7,
+};
+
+//! An entry in the array of values passed to org.qore.jni.QoreDataDecoder with the buffer
+struct DataEntry {
+    //! a value that must be converted individually
+    QoreValue value;
+    //! a Java object owned by the key cache or by the encoder that is passed as-is, if not nullptr
+    jobject ref;
+
+    DLLLOCAL DataEntry(const QoreValue& value) : value(value), ref(nullptr) {
+    }
+
+    DLLLOCAL DataEntry(jobject ref) : ref(ref) {
+    }
+};
+
+//! Encodes a Qore value in the format read by org.qore.jni.QoreDataDecoder
+class DataEncoder {
+public:
+    //! the encoded data
+    std::string buf;
+    //! values that must be converted individually, hash keys from the key cache, and list element classes
+    std::vector<DataEntry> objects;
+
+    DLLLOCAL DataEncoder(Env& env, JniExternalProgramData* jpc) : env(env), jpc(jpc),
+            lazy_hashes(JniExternalProgramData::lazyHashes()) {
+    }
+
+    DLLLOCAL void encode(const QoreValue& v) {
+        switch (v.getType()) {
+            case NT_NOTHING:
+            case NT_NULL:
+                putTag(T_NULL);
+                return;
+
+            case NT_BOOLEAN:
+                putTag(v.getAsBool() ? T_TRUE : T_FALSE);
+                return;
+
+            case NT_INT:
+                putTag(T_INT);
+                put<int64>(v.getAsBigInt());
+                return;
+
+            case NT_FLOAT:
+                putTag(T_FLOAT);
+                put<double>(v.getAsFloat());
+                return;
+
+            case NT_STRING:
+                putTag(T_STRING);
+                putString(*v.get<const QoreStringNode>());
+                return;
+
+            case NT_BINARY: {
+                // binary values are passed as direct buffers if the "byte-buffers" option is set
+                if (jni_byte_buffers) {
+                    break;
+                }
+                const BinaryNode* b = v.get<const BinaryNode>();
+                putTag(T_BINARY);
+                putBytes(b->getPtr(), b->size());
+                return;
+            }
+
+            case NT_DATE: {
+                const DateTimeNode* d = v.get<const DateTimeNode>();
+                // relative dates are converted individually
+                if (!d->isAbsolute()) {
+                    break;
+                }
+                putTag(T_DATE);
+                put<int64>(d->getEpochSecondsUTC());
+                put<jint>(d->getMicrosecond());
+                put<jint>(d->getUTCOffset());
+                return;
+            }
+
+            case NT_NUMBER: {
+                // numbers with large unscaled values are converted individually
+                QoreString str;
+                v.get<const QoreNumberNode>()->toString(str);
+                bool negative;
+                std::string digits;
+                int64 scale;
+                int64 unscaled;
+                if (!NumberConverter::parseDecimal(str.c_str(), negative, digits, scale)
+                    || scale < INT_MIN || scale > INT_MAX
+                    || !NumberConverter::digitsToLong(digits, negative, unscaled)) {
+                    break;
+                }
+                putTag(T_NUMBER);
+                put<int64>(unscaled);
+                put<jint>(static_cast<jint>(scale));
+                return;
+            }
+
+            case NT_HASH: {
+                // hashes are passed as lazy proxies if the "lazy-hashes" option is set
+                if (lazy_hashes) {
+                    break;
+                }
+                const QoreHashNode* h = v.get<const QoreHashNode>();
+                putTag(T_HASH);
+                putSize(h->size());
+                ConstHashIterator i(h);
+                while (i.next()) {
+                    putKey(i.getKey());
+                    encode(i.get());
+                }
+                return;
+            }
+
+            case NT_LIST: {
+                const QoreListNode* l = v.get<const QoreListNode>();
+                putTag(T_LIST);
+                putSize(l->size());
+                if (l->empty()) {
+                    return;
+                }
+                putElementClass(l);
+                for (size_t i = 0, e = l->size(); i < e; ++i) {
+                    encode(l->retrieveEntry(i));
+                }
+                return;
+            }
+
+            default:
+                break;
+        }
+
+        putTag(T_OBJECT);
+        putSize(objects.size());
+        objects.push_back(v);
+    }
+
+private:
+    Env& env;
+    JniExternalProgramData* jpc;
+    //! true if hashes are passed as lazy proxies
+    bool lazy_hashes;
+    //! indexes of hash keys already written
+    std::unordered_map<std::string, jint> keys;
+    //! list element classes for objects and their indexes in the object array
+    std::vector<std::pair<LocalReference<jclass>, jint>> classes;
+
+    template <typename T>
+    DLLLOCAL void put(T v) {
+        buf.append(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+
+    DLLLOCAL void putTag(unsigned char tag) {
+        buf += static_cast<char>(tag);
+    }
+
+    DLLLOCAL void putSize(size_t size) {
+        if (size > INT_MAX) {
+            QoreStringMaker desc("cannot convert a value with " QLLD " elements to Java; the maximum size is %d",
+                (int64)size, INT_MAX);
+            throw BasicException(desc.c_str());
+        }
+        put<jint>(static_cast<jint>(size));
+    }
+
+    DLLLOCAL void putBytes(const void* data, size_t len) {
+        putSize(len);
+        buf.append(static_cast<const char*>(data), len);
+    }
+
+    DLLLOCAL void putString(const QoreString& str) {
+        if (str.getEncoding() == QCS_UTF8) {
+            putBytes(str.c_str(), str.size());
+            return;
+        }
+
+        ExceptionSink xsink;
+        TempEncodingHelper utf8;
+        utf8.set(&str, QCS_UTF8, &xsink);
+        if (xsink) {
+            throw XsinkException(xsink);
+        }
+        putBytes(utf8->c_str(), utf8->size());
+    }
+
+    //! writes the index of a known key, a key from the key cache, or a new key with its length
+    /** Keys are encoded as an index greater than or equal to 0 for known keys, -1 followed by the index in the
+        object array for cached keys, or -(len + 2) followed by the UTF-8 bytes for new keys
+    */
+    DLLLOCAL void putKey(const char* key) {
+        std::string k(key);
+        auto i = keys.find(k);
+        if (i != keys.end()) {
+            put<jint>(i->second);
+            return;
+        }
+        jstring cached = QoreToJava::getCachedKey(env, key);
+        if (cached) {
+            put<jint>(-1);
+            putSize(objects.size());
+            objects.push_back(DataEntry(cached));
+        } else {
+            if (k.size() >= INT_MAX - 1) {
+                QoreStringMaker desc("cannot convert a hash key of size " QLLD " to Java", (int64)k.size());
+                throw BasicException(desc.c_str());
+            }
+            put<jint>(-static_cast<jint>(k.size()) - 2);
+            buf.append(k);
+        }
+        keys.insert(std::make_pair(std::move(k), static_cast<jint>(keys.size())));
+    }
+
+    //! writes the element class of a non-empty list with the same rules as Array::toJava()
+    DLLLOCAL void putElementClass(const QoreListNode* l) {
+        bool mixed;
+        QoreValue v = Array::getFirstElement(l, 0, mixed);
+        unsigned char ec;
+        switch (v.getType()) {
+            case NT_NOTHING:
+            case NT_DATE:
+            case NT_LIST:
+                ec = E_OBJECT;
+                break;
+            case NT_INT:
+                ec = E_LONG;
+                break;
+            case NT_FLOAT:
+                ec = E_DOUBLE;
+                break;
+            case NT_BOOLEAN:
+                ec = E_BOOLEAN;
+                break;
+            case NT_STRING:
+                ec = E_STRING;
+                break;
+            case NT_NUMBER:
+                ec = E_NUMBER;
+                break;
+            case NT_HASH:
+                ec = E_HASH;
+                break;
+            default: {
+                // raises an exception for values that cannot be stored in arrays, even if the list has mixed types
+                LocalReference<jclass> cls = Array::getClassForValue(v, jpc);
+                if (!cls || mixed) {
+                    ec = E_OBJECT;
+                    break;
+                }
+                putTag(E_CLASS);
+                put<jint>(getClassIndex(std::move(cls)));
+                return;
+            }
+        }
+        putTag(mixed ? E_OBJECT : ec);
+    }
+
+    //! returns the index of the given class in the object array, adding it if necessary
+    DLLLOCAL jint getClassIndex(LocalReference<jclass> cls) {
+        for (auto& i : classes) {
+            if (env.isSameObject(i.first, cls)) {
+                return i.second;
+            }
+        }
+        jint idx = static_cast<jint>(objects.size());
+        objects.push_back(DataEntry(static_cast<jclass>(cls)));
+        classes.push_back(std::make_pair(std::move(cls), idx));
+        return idx;
+    }
+};
+}
+
+LocalReference<jobject> DataMarshaller::toJava(Env& env, const QoreValue& value, JniExternalProgramData* jpc) {
+    DataEncoder enc(env, jpc);
+    enc.encode(value);
+
+    LocalReference<jobjectArray> objects;
+    if (!enc.objects.empty()) {
+        objects = env.newObjectArray(enc.objects.size(), Globals::classObject);
+        // local references for each element are freed in bulk when the frame is recycled
+        Env::LocalFrame frame(env);
+        for (size_t i = 0, e = enc.objects.size(); i < e; ++i) {
+            frame.next();
+            const DataEntry& entry = enc.objects[i];
+            if (entry.ref) {
+                env.setObjectArrayElement(objects, i, entry.ref);
+            } else {
+                env.setObjectArrayElement(objects, i, QoreToJava::toAnyObject(entry.value, jpc));
+            }
+        }
+    }
+
+    // the buffer is only accessed during the call
+    LocalReference<jobject> buf = env.newDirectByteBuffer(&enc.buf[0], enc.buf.size());
+    jvalue jargs[2];
+    jargs[0].l = buf;
+    jargs[1].l = objects;
+    return env.callStaticObjectMethod(Globals::classQoreDataDecoder, Globals::methodQoreDataDecoderDecode, jargs);
+}
+
+} // namespace jni
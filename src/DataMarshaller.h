@@ -0,0 +1,73 @@
+//--------------------------------------------------------------------*- C++ -*-
+//
+//  Qore Programming Language
+//
+//  Copyright (C) 2016 - 2021 Qore Technologies, s.r.o.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//------------------------------------------------------------------------------
+///
+/// \file
+/// \brief Defines the DataMarshaller class.
+///
+//------------------------------------------------------------------------------
+#ifndef QORE_JNI_DATAMARSHALLER_H_
+#define QORE_JNI_DATAMARSHALLER_H_
+
+#include <qore/Qore.h>
+#include <jni.h>
+
+#include "LocalReference.h"
+#include "Env.h"
+
+namespace jni {
+
+// forward reference
+class JniExternalProgramData;
+
+/**
+ * \brief Converts nested Qore data structures to Java with a single call.
+ *
+ * The value is encoded in a native buffer that is passed to Java as a direct java.nio.ByteBuffer and decoded by
+ * org.qore.jni.QoreDataDecoder, so the number of JNI calls does not depend on the number of elements.  Values
+ * that cannot be encoded (ex: objects and closures) are converted individually and passed in a side array along
+ * with hash keys from the key cache and list element classes.  The result is the same as with
+ * QoreToJava::toAnyObject(), including the element classes of arrays created for lists.
+ */
+class DataMarshaller {
+public:
+    /**
+     * \brief Converts a hash or list to a Java object.
+     * \param env the JNI environment
+     * \param value the value to convert
+     * \param jpc the program context for converting Qore objects, if any
+     * \return the Java object
+     * \throws Exception if the value cannot be converted
+     */
+    DLLLOCAL static LocalReference<jobject> toJava(Env& env, const QoreValue& value,
+            JniExternalProgramData* jpc = nullptr);
+
+private:
+    DataMarshaller() = delete;
+};
+
+} // namespace jni
+
+#endif // QORE_JNI_DATAMARSHALLER_H_
@@ -999,6 +999,26 @@ public:
         return env->IsInstanceOf(obj, cls) == JNI_TRUE;
     }
 
+    /**
+     * \brief Checks whether objects of one class can be safely cast to another class.
+     * \param cls the class to check
+     * \param target the target class
+     * \return true if \a cls is the same as or a subtype of \a target
+     */
+    DLLLOCAL bool isAssignableFrom(jclass cls, jclass target) {
+        return env->IsAssignableFrom(cls, target) == JNI_TRUE;
+    }
+
+    /**
+     * \brief Creates a new local reference to the given object.
+     * \param ref the object; may be a local or global reference
+     * \return a new local reference that can be released independently of the original reference
+     */
+    template <typename T>
+    DLLLOCAL LocalReference<T> newLocalRef(T ref) {
+        return static_cast<T>(env->NewLocalRef(ref));
+    }
+
     /**
      * \brief Creates a new Java object.
      * \param cls the class of the object
@@ -1023,6 +1043,87 @@ public:
         return s;
     }
 
+    /**
+     * \brief Creates a new Java string from UTF-16 code units.
+     * \param chars the UTF-16 code units
+     * \param len the number of code units
+     * \return the new string
+     * \throws JavaException if the string cannot be created
+     */
+    DLLLOCAL LocalReference<jstring> newString(const jchar* chars, jsize len) {
+        jstring s = env->NewString(chars, len);
+        if (s == nullptr) {
+            throw JavaException();
+        }
+        return s;
+    }
+
+    /**
+     * \brief Creates a direct java.nio.ByteBuffer referring to the given memory.
+     * \param address the start of the memory region
+     * \param capacity the size of the memory region
+     * \return the new buffer
+     * \throws JavaException if the buffer cannot be created
+     */
+    DLLLOCAL LocalReference<jobject> newDirectByteBuffer(void* address, jlong capacity) {
+        jobject buf = env->NewDirectByteBuffer(address, capacity);
+        if (buf == nullptr) {
+            throw JavaException();
+        }
+        return buf;
+    }
+
+    /**
+     * \brief Returns the memory referred to by a direct java.nio.ByteBuffer.
+     * \param buf the buffer
+     * \return the start of the memory region or nullptr if \a buf is not a direct buffer
+     */
+    DLLLOCAL void* getDirectBufferAddress(jobject buf) {
+        return env->GetDirectBufferAddress(buf);
+    }
+
+    /**
+     * \brief Returns the capacity of a direct java.nio.ByteBuffer.
+     * \param buf the buffer
+     * \return the capacity of the buffer or -1 if \a buf is not a direct buffer
+     */
+    DLLLOCAL jlong getDirectBufferCapacity(jobject buf) {
+        return env->GetDirectBufferCapacity(buf);
+    }
+
+    /**
+     * \brief Returns the length of a Java string in UTF-16 code units.
+     * \param str the string
+     * \return the number of UTF-16 code units in the string
+     */
+    DLLLOCAL jsize getStringLength(jstring str) {
+        return env->GetStringLength(str);
+    }
+
+    /**
+     * \brief Returns the length of a Java string in modified UTF-8 encoding.
+     * \param str the string
+     * \return the number of bytes needed to represent the string in modified UTF-8 encoding
+     */
+    DLLLOCAL jsize getStringUtfLength(jstring str) {
+        return env->GetStringUTFLength(str);
+    }
+
+    /**
+     * \brief Copies UTF-16 code units from a Java string to a buffer.
+     * \param str the string
+     * \param start the index of the first code unit to copy
+     * \param len the number of code units to copy
+     * \param buf the destination buffer
+     * \throws JavaException if the region is out of bounds
+     */
+    DLLLOCAL void getStringRegion(jstring str, jsize start, jsize len, jchar* buf) {
+        env->GetStringRegion(str, start, len, buf);
+        if (env->ExceptionCheck()) {
+            throw JavaException();
+        }
+    }
+
     DLLLOCAL void registerNatives(jclass cls, const JNINativeMethod *methods, jint count) {
         if (env->RegisterNatives(cls, methods, count) != 0) {
             throw JavaException();
@@ -1248,6 +1349,186 @@ public:
         }
     }
 
+    //! Size in bytes above which byte array transfers pin the array instead of using region copies
+    /** region copies are cheapest for small arrays; for large arrays pinning the array lets us do a single plain
+        memcpy() without the JVM's intermediate bounds checks and safepoint polling
+    */
+    static constexpr jsize CriticalCopyThreshold = 256 * 1024;
+
+    /**
+     * \brief Copies the contents of a byte array into a native buffer.
+     *
+     * Uses a region copy for small arrays and critical pinning for arrays larger than CriticalCopyThreshold.
+     * \param array the array
+     * \param buf the destination buffer; must be at least \a len bytes long
+     * \param len the number of bytes to copy
+     * \throws JavaException if the copy fails
+     */
+    DLLLOCAL void getBytes(jbyteArray array, void* buf, jsize len) {
+        if (!len) {
+            return;
+        }
+        if (len < CriticalCopyThreshold) {
+            getArrayRegion(array, 0, len, reinterpret_cast<jbyte*>(buf));
+            return;
+        }
+        PrimitiveArrayCritical pin(*this, array);
+        memcpy(buf, pin.get(), len);
+    }
+
+    /**
+     * \brief Copies a native buffer into a byte array.
+     *
+     * Uses a region copy for small arrays and critical pinning for arrays larger than CriticalCopyThreshold.
+     * \param array the array
+     * \param buf the source buffer
+     * \param len the number of bytes to copy
+     * \throws JavaException if the copy fails
+     */
+    DLLLOCAL void setBytes(jbyteArray array, const void* buf, jsize len) {
+        if (!len) {
+            return;
+        }
+        if (len < CriticalCopyThreshold) {
+            setArrayRegion(array, 0, len, reinterpret_cast<const jbyte*>(buf));
+            return;
+        }
+        PrimitiveArrayCritical pin(*this, array);
+        memcpy(pin.get(), buf, len);
+    }
+
+    /**
+     * \brief Copies a region of a primitive array into a native buffer with a single JNI call.
+     *
+     * Overloaded for all primitive array types so that it can be used from templates.
+     * \param array the array
+     * \param start the starting index
+     * \param len the number of elements to copy
+     * \param buf the destination buffer; must have room for at least \a len elements
+     * \throws JavaException if the region is out of bounds
+     */
+    DLLLOCAL void getArrayRegion(jbooleanArray array, jsize start, jsize len, jboolean* buf) {
+        env->GetBooleanArrayRegion(array, start, len, buf);
+        if (env->ExceptionCheck()) {
+            throw JavaException();
+        }
+    }
+
+    DLLLOCAL void getArrayRegion(jbyteArray array, jsize start, jsize len, jbyte* buf) {
+        env->GetByteArrayRegion(array, start, len, buf);
+        if (env->ExceptionCheck()) {
+            throw JavaException();
+        }
+    }
+
+    DLLLOCAL void getArrayRegion(jcharArray array, jsize start, jsize len, jchar* buf) {
+        env->GetCharArrayRegion(array, start, len, buf);
+        if (env->ExceptionCheck()) {
+            throw JavaException();
+        }
+    }
+
+    DLLLOCAL void getArrayRegion(jshortArray array, jsize start, jsize len, jshort* buf) {
+        env->GetShortArrayRegion(array, start, len, buf);
+        if (env->ExceptionCheck()) {
+            throw JavaException();
+        }
+    }
+
+    DLLLOCAL void getArrayRegion(jintArray array, jsize start, jsize len, jint* buf) {
+        env->GetIntArrayRegion(array, start, len, buf);
+        if (env->ExceptionCheck()) {
+            throw JavaException();
+        }
+    }
+
+    DLLLOCAL void getArrayRegion(jlongArray array, jsize start, jsize len, jlong* buf) {
+        env->GetLongArrayRegion(array, start, len, buf);
+        if (env->ExceptionCheck()) {
+            throw JavaException();
+        }
+    }
+
+    DLLLOCAL void getArrayRegion(jfloatArray array, jsize start, jsize len, jfloat* buf) {
+        env->GetFloatArrayRegion(array, start, len, buf);
+        if (env->ExceptionCheck()) {
+            throw JavaException();
+        }
+    }
+
+    DLLLOCAL void getArrayRegion(jdoubleArray array, jsize start, jsize len, jdouble* buf) {
+        env->GetDoubleArrayRegion(array, start, len, buf);
+        if (env->ExceptionCheck()) {
+            throw JavaException();
+        }
+    }
+
+    /**
+     * \brief Copies a native buffer into a region of a primitive array with a single JNI call.
+     *
+     * Overloaded for all primitive array types so that it can be used from templates.
+     * \param array the array
+     * \param start the starting index
+     * \param len the number of elements to copy
+     * \param buf the source buffer
+     * \throws JavaException if the region is out of bounds
+     */
+    DLLLOCAL void setArrayRegion(jbooleanArray array, jsize start, jsize len, const jboolean* buf) {
+        env->SetBooleanArrayRegion(array, start, len, buf);
+        if (env->ExceptionCheck()) {
+            throw JavaException();
+        }
+    }
+
+    DLLLOCAL void setArrayRegion(jbyteArray array, jsize start, jsize len, const jbyte* buf) {
+        env->SetByteArrayRegion(array, start, len, buf);
+        if (env->ExceptionCheck()) {
+            throw JavaException();
+        }
+    }
+
+    DLLLOCAL void setArrayRegion(jcharArray array, jsize start, jsize len, const jchar* buf) {
+        env->SetCharArrayRegion(array, start, len, buf);
+        if (env->ExceptionCheck()) {
+            throw JavaException();
+        }
+    }
+
+    DLLLOCAL void setArrayRegion(jshortArray array, jsize start, jsize len, const jshort* buf) {
+        env->SetShortArrayRegion(array, start, len, buf);
+        if (env->ExceptionCheck()) {
+            throw JavaException();
+        }
+    }
+
+    DLLLOCAL void setArrayRegion(jintArray array, jsize start, jsize len, const jint* buf) {
+        env->SetIntArrayRegion(array, start, len, buf);
+        if (env->ExceptionCheck()) {
+            throw JavaException();
+        }
+    }
+
+    DLLLOCAL void setArrayRegion(jlongArray array, jsize start, jsize len, const jlong* buf) {
+        env->SetLongArrayRegion(array, start, len, buf);
+        if (env->ExceptionCheck()) {
+            throw JavaException();
+        }
+    }
+
+    DLLLOCAL void setArrayRegion(jfloatArray array, jsize start, jsize len, const jfloat* buf) {
+        env->SetFloatArrayRegion(array, start, len, buf);
+        if (env->ExceptionCheck()) {
+            throw JavaException();
+        }
+    }
+
+    DLLLOCAL void setArrayRegion(jdoubleArray array, jsize start, jsize len, const jdouble* buf) {
+        env->SetDoubleArrayRegion(array, start, len, buf);
+        if (env->ExceptionCheck()) {
+            throw JavaException();
+        }
+    }
+
     DLLLOCAL LocalReference<jobject> toReflectedField(jclass cls, jfieldID id, jboolean isStatic) {
         jobject o = env->ToReflectedField(cls, id, isStatic);
         if (o == nullptr) {
@@ -1289,6 +1570,24 @@ public:
         return env->GetObjectClass(obj);
     }
 
+    /**
+     * \brief Creates a weak global reference that does not prevent the object from being garbage collected.
+     * \param obj the object
+     * \return the weak global reference; must be freed with deleteWeakGlobalRef()
+     * \throws JavaException if the reference cannot be created
+     */
+    DLLLOCAL jweak newWeakGlobalRef(jobject obj) {
+        jweak ref = env->NewWeakGlobalRef(obj);
+        if (ref == nullptr) {
+            throw JavaException();
+        }
+        return ref;
+    }
+
+    DLLLOCAL void deleteWeakGlobalRef(jweak ref) {
+        env->DeleteWeakGlobalRef(ref);
+    }
+
     DLLLOCAL void throwException(jthrowable throwable) {
         env->Throw(throwable);
     }
@@ -1376,10 +1675,124 @@ public:
         const char* chars;
     };
 
+    //! Pins the contents of a primitive array for direct access
+    /** no JNI calls may be made and the thread must not block while an object of this class is in scope
+    */
+    class PrimitiveArrayCritical {
+    public:
+        DLLLOCAL PrimitiveArrayCritical(Env& env, jarray array) : env(env), array(array),
+            ptr(env.env->GetPrimitiveArrayCritical(array, nullptr)) {
+            if (!ptr) {
+                throw JavaException();
+            }
+        }
+
+        DLLLOCAL ~PrimitiveArrayCritical() {
+            env.env->ReleasePrimitiveArrayCritical(array, ptr, 0);
+        }
+
+        DLLLOCAL void* get() const {
+            return ptr;
+        }
+
+    private:
+        Env& env;
+        jarray array;
+        void* ptr;
+    };
+
+    //! Provides direct access to the UTF-16 code units of a Java string
+    /** no JNI functions may be called while an instance exists
+    */
+    class StringCritical {
+    public:
+        DLLLOCAL StringCritical(Env& env, jstring str) : env(env), str(str),
+            ptr(env.env->GetStringCritical(str, nullptr)) {
+            if (!ptr) {
+                throw JavaException();
+            }
+        }
+
+        DLLLOCAL ~StringCritical() {
+            env.env->ReleaseStringCritical(str, ptr);
+        }
+
+        DLLLOCAL const jchar* get() const {
+            return ptr;
+        }
+
+    private:
+        Env& env;
+        jstring str;
+        const jchar* ptr;
+    };
+
+    //! Manages a JNI local reference frame for loops that create local references for each element
+    /** local references created while the frame is active are freed together when the frame is popped instead of
+        with a \c DeleteLocalRef() call each; loops call next() once per element before creating any references for
+        it, which recycles the frame every \a elements iterations so that local reference usage stays bounded
+        regardless of the size and nesting depth of the data being converted
+
+        \note references created in the frame must not be used after next() is called or the frame goes out of
+        scope; any LocalReference objects created in the frame must be released or destroyed before then
+    */
+    class LocalFrame {
+    public:
+        //! Default number of loop iterations per frame
+        static constexpr jint DefaultElements = 64;
+
+        /**
+         * \brief Pushes a new local reference frame.
+         * \param env the environment
+         * \param elements the number of loop iterations to run in each frame before it is recycled
+         * \param refs_per_element the number of local references created in each iteration
+         * \throws JavaException if the frame cannot be allocated
+         */
+        DLLLOCAL LocalFrame(Env& env, jint elements = DefaultElements, jint refs_per_element = 4) : env(env),
+                elements(elements), capacity(elements * refs_per_element) {
+            push();
+        }
+
+        DLLLOCAL ~LocalFrame() {
+            if (active) {
+                env.env->PopLocalFrame(nullptr);
+            }
+        }
+
+        //! Must be called at the start of each loop iteration; frees all references in the frame when it is full
+        /** \throws JavaException if a new frame cannot be allocated
+        */
+        DLLLOCAL void next() {
+            if (++count > elements) {
+                env.env->PopLocalFrame(nullptr);
+                active = false;
+                push();
+                count = 1;
+            }
+        }
+
+    private:
+        Env& env;
+        jint elements;
+        jint capacity;
+        jint count = 0;
+        bool active = false;
+
+        DLLLOCAL void push() {
+            if (env.env->PushLocalFrame(capacity) < 0) {
+                throw JavaException();
+            }
+            active = true;
+        }
+    };
+
 private:
     JNIEnv* env;
 
     friend class GetStringUtfChars;
+    friend class PrimitiveArrayCritical;
+    friend class StringCritical;
+    friend class LocalFrame;
 };
 
 } // namespace jni
@@ -36,19 +36,27 @@
 #include "Array.h"
 #include "QoreToJava.h"
 #include "QoreJniClassMap.h"
+#include "JavaToQore.h"
+#include "StringTranscoder.h"
 
-#include <bzlib.h>
+#include <zlib.h>
+#include <algorithm>
 #include <dlfcn.h>
 
 namespace jni {
 
 // Qore initialization flag
 bool jni_qore_init = false;
+int jni_box_cache_high = 127;
 
 ExceptionSink Globals::global_xsink;
 std::unique_ptr<QoreProgramHelper> Globals::qph;
 
 bool Globals::already_initialized = false;
+GlobalReference<jobject> Globals::booleanTrue;
+GlobalReference<jobject> Globals::booleanFalse;
+std::vector<GlobalReference<jobject>> Globals::integerCache;
+std::vector<GlobalReference<jobject>> Globals::longCache;
 
 GlobalReference<jobject> Globals::syscl;
 
@@ -67,6 +75,8 @@ GlobalReference<jclass> Globals::arrayClassObject;
 GlobalReference<jclass> Globals::classSystem;
 jmethodID Globals::methodSystemSetProperty;
 jmethodID Globals::methodSystemGetProperty;
+jmethodID Globals::methodSystemIdentityHashCode;
+jmethodID Globals::methodSystemArraycopy;
 
 GlobalReference<jclass> Globals::classObject;
 jmethodID Globals::methodObjectClone;
@@ -135,6 +145,10 @@ jmethodID Globals::methodQoreInvocationHandlerDestroy;
 
 GlobalReference<jclass> Globals::classQoreJavaApi;
 jmethodID Globals::methodQoreJavaApiGetStackTrace;
+jmethodID Globals::methodQoreJavaApiFlattenMap;
+jmethodID Globals::methodQoreJavaApiPutAll;
+jmethodID Globals::methodQoreJavaApiGetUnscaledLong;
+jmethodID Globals::methodQoreJavaApiGetUnscaledBytes;
 
 GlobalReference<jclass> Globals::classQoreExceptionWrapper;
 jmethodID Globals::ctorQoreExceptionWrapper;
@@ -201,6 +215,10 @@ jmethodID Globals::methodJavaClassBuilderGetByteCodeFromBuilder;
 jmethodID Globals::methodJavaClassBuilderGetTypeDescriptionCls;
 jmethodID Globals::methodJavaClassBuilderGetTypeDescriptionStr;
 jmethodID Globals::methodJavaClassBuilderFindBaseClassMethodConflict;
+jmethodID Globals::methodJavaClassBuilderLoadCachedByteCode;
+jmethodID Globals::methodJavaClassBuilderStoreCachedByteCode;
+jmethodID Globals::methodJavaClassBuilderRelocateByteCode;
+jmethodID Globals::methodJavaClassBuilderGetByteCodeCacheEnvironment;
 
 GlobalReference<jclass> Globals::classGraphicsEnvironment;
 jmethodID Globals::methodGraphicsEnvironmentIsHeadless;
@@ -209,17 +227,37 @@ GlobalReference<jclass> Globals::classThread;
 jmethodID Globals::methodThreadCurrentThread;
 jmethodID Globals::methodThreadGetContextClassLoader;
 
+GlobalReference<jclass> Globals::classByteBuffer;
+
+GlobalReference<jclass> Globals::classQoreBinaryBuffer;
+jmethodID Globals::methodQoreBinaryBufferRegister;
+jmethodID Globals::methodQoreBinaryBufferStopCleaner;
+
 GlobalReference<jclass> Globals::classHashMap;
+jmethodID Globals::ctorHashMapSized;
 GlobalReference<jclass> Globals::classHash;
 jmethodID Globals::ctorHash;
+jmethodID Globals::ctorHashSized;
 jmethodID Globals::methodHashPut;
 
+GlobalReference<jclass> Globals::classQoreDataDecoder;
+jmethodID Globals::methodQoreDataDecoderDecode;
+
+GlobalReference<jclass> Globals::classQoreHashProxy;
+jmethodID Globals::ctorQoreHashProxy;
+jmethodID Globals::methodQoreHashProxyGetHashPtr;
+jmethodID Globals::methodQoreHashProxyStopCleaner;
+
 GlobalReference<jclass> Globals::classMap;
 jmethodID Globals::methodMapEntrySet;
+jmethodID Globals::methodMapGet;
+jmethodID Globals::methodMapContainsKey;
+jmethodID Globals::methodMapSize;
 
 GlobalReference<jclass> Globals::classList;
 jmethodID Globals::methodListSize;
 jmethodID Globals::methodListGet;
+jmethodID Globals::methodListToArray;
 
 GlobalReference<jclass> Globals::classArrayList;
 jmethodID Globals::ctorArrayList;
@@ -243,6 +281,17 @@ jmethodID Globals::methodIteratorNext;
 GlobalReference<jclass> Globals::classZonedDateTime;
 jmethodID Globals::methodZonedDateTimeParse;
 jmethodID Globals::methodZonedDateTimeToString;
+jmethodID Globals::methodZonedDateTimeOfInstant;
+jmethodID Globals::methodZonedDateTimeToEpochSecond;
+jmethodID Globals::methodZonedDateTimeGetNano;
+jmethodID Globals::methodZonedDateTimeGetOffset;
+
+GlobalReference<jclass> Globals::classInstant;
+jmethodID Globals::methodInstantOfEpochSecond;
+
+GlobalReference<jclass> Globals::classZoneOffset;
+jmethodID Globals::methodZoneOffsetOfTotalSeconds;
+jmethodID Globals::methodZoneOffsetGetTotalSeconds;
 
 GlobalReference<jclass> Globals::classQoreRelativeTime;
 jmethodID Globals::ctorQoreRelativeTime;
@@ -257,21 +306,31 @@ jfieldID Globals::fieldQoreRelativeTimeUs;
 GlobalReference<jclass> Globals::classBigDecimal;
 jmethodID Globals::ctorBigDecimal;
 jmethodID Globals::methodBigDecimalToString;
+jmethodID Globals::ctorBigDecimalBigIntegerInt;
+jmethodID Globals::methodBigDecimalValueOf;
+jmethodID Globals::methodBigDecimalScale;
+
+GlobalReference<jclass> Globals::classBigInteger;
+jmethodID Globals::ctorBigIntegerSignumMagnitude;
 
 GlobalReference<jclass> Globals::classArrays;
 jmethodID Globals::methodArraysToString;
 jmethodID Globals::methodArraysDeepToString;
+jmethodID Globals::methodArraysFill;
 
 GlobalReference<jclass> Globals::classBoolean;
 jmethodID Globals::ctorBoolean;
+jmethodID Globals::methodBooleanValueOf;
 jmethodID Globals::methodBooleanBooleanValue;
 
 GlobalReference<jclass> Globals::classInteger;
 jmethodID Globals::ctorInteger;
+jmethodID Globals::methodIntegerValueOf;
 jmethodID Globals::methodIntegerIntValue;
 
 GlobalReference<jclass> Globals::classLong;
 jmethodID Globals::ctorLong;
+jmethodID Globals::methodLongValueOf;
 jmethodID Globals::methodLongLongValue;
 
 GlobalReference<jclass> Globals::classShort;
@@ -284,6 +343,7 @@ jmethodID Globals::methodByteByteValue;
 
 GlobalReference<jclass> Globals::classDouble;
 jmethodID Globals::ctorDouble;
+jmethodID Globals::methodDoubleValueOf;
 jmethodID Globals::methodDoubleDoubleValue;
 
 GlobalReference<jclass> Globals::classFloat;
@@ -677,6 +737,109 @@ static jobject JNICALL java_api_new_object_save(JNIEnv* jenv, jobject obj, jlong
     }
 }
 
+static void JNICALL qore_binary_buffer_release(JNIEnv*, jclass, jlong ptr) {
+    assert(ptr);
+    // the thread must be attached, as Qore values must only be released by Qore threads
+    QoreThreadAttachHelper attach_helper;
+    try {
+        attach_helper.attach();
+    } catch (Exception& e) {
+        // the binary value cannot be released safely without a Qore thread
+        return;
+    }
+
+    QoreToJava::releaseDirectBinary(reinterpret_cast<BinaryNode*>(ptr));
+}
+
+// private native Object get0(long ptr, String key);
+static jobject JNICALL qore_hash_proxy_get(JNIEnv* jenv, jobject, jlong ptr, jstring key) {
+    assert(ptr);
+    const QoreHashNode* h = reinterpret_cast<const QoreHashNode*>(ptr);
+
+    Env env(jenv);
+    QoreThreadAttachHelper attach_helper;
+    try {
+        attach_helper.attach();
+    } catch (Exception& e) {
+        env.throwNew(env.findClass("java/lang/RuntimeException"), "Unable to attach thread to Qore");
+        return nullptr;
+    }
+
+    try {
+        SimpleRefHolder<QoreStringNode> k(StringTranscoder::toQore(env, key));
+        return QoreToJava::toAnyObject(h->getKeyValue(k->c_str()), jni_get_context());
+    } catch (jni::Exception& e) {
+        ExceptionSink xsink;
+        e.convert(&xsink);
+        QoreToJava::wrapException(xsink);
+        return nullptr;
+    }
+}
+
+// private native boolean containsKey0(long ptr, String key);
+static jboolean JNICALL qore_hash_proxy_contains_key(JNIEnv* jenv, jobject, jlong ptr, jstring key) {
+    assert(ptr);
+    const QoreHashNode* h = reinterpret_cast<const QoreHashNode*>(ptr);
+
+    Env env(jenv);
+    QoreThreadAttachHelper attach_helper;
+    try {
+        attach_helper.attach();
+    } catch (Exception& e) {
+        env.throwNew(env.findClass("java/lang/RuntimeException"), "Unable to attach thread to Qore");
+        return false;
+    }
+
+    try {
+        SimpleRefHolder<QoreStringNode> k(StringTranscoder::toQore(env, key));
+        return h->existsKey(k->c_str());
+    } catch (jni::Exception& e) {
+        ExceptionSink xsink;
+        e.convert(&xsink);
+        QoreToJava::wrapException(xsink);
+        return false;
+    }
+}
+
+// private native String[] keys0(long ptr);
+static jobjectArray JNICALL qore_hash_proxy_keys(JNIEnv* jenv, jobject, jlong ptr) {
+    assert(ptr);
+    Env env(jenv);
+    QoreThreadAttachHelper attach_helper;
+    try {
+        attach_helper.attach();
+    } catch (Exception& e) {
+        env.throwNew(env.findClass("java/lang/RuntimeException"), "Unable to attach thread to Qore");
+        return nullptr;
+    }
+
+    try {
+        return QoreToJava::makeKeyArray(env, *reinterpret_cast<const QoreHashNode*>(ptr));
+    } catch (jni::Exception& e) {
+        ExceptionSink xsink;
+        e.convert(&xsink);
+        QoreToJava::wrapException(xsink);
+        return nullptr;
+    }
+}
+
+// private static native void release0(long ptr);
+static void JNICALL qore_hash_proxy_release(JNIEnv*, jclass, jlong ptr) {
+    assert(ptr);
+    // the thread must be attached, as releasing the hash can run the destructors of objects in it
+    QoreThreadAttachHelper attach_helper;
+    try {
+        attach_helper.attach();
+    } catch (Exception& e) {
+        // the hash cannot be released safely without a Qore thread
+        return;
+    }
+
+    ExceptionSink xsink;
+    reinterpret_cast<QoreHashNode*>(ptr)->deref(&xsink);
+    xsink.clear();
+}
+
 static void JNICALL qore_exception_wrapper_finalize(JNIEnv*, jclass, jlong ptr) {
     ExceptionSink* xsink = reinterpret_cast<ExceptionSink*>(ptr);
     //printd(LogLevel, "qore_exception_wrapper_finalize() xsink: %p\n", xsink);
@@ -918,42 +1081,74 @@ static jobject JNICALL qore_object_get_member_value(JNIEnv* jenv, jobject jobj,
     }
 }
 
-struct class_info_t {
+//! index entry for a compressed class in the embedded jar; entries are sorted by binary name in byte order
+struct jar_class_info_t {
+    //! the binary name of the class (ex: java.lang.Class)
+    const char* bname;
+    //! the length of the compressed class data
     unsigned compressed_len;
+    //! the length of the uncompressed class data
     unsigned len;
-    unsigned char* byte_code;
+    //! the gzip-compressed class data
+    const unsigned char* byte_code;
 };
 
-typedef std::map<const char*, class_info_t, ltstr> cmap_t;
+DLLLOCAL extern const jar_class_info_t jar_classes[];
+DLLLOCAL extern const size_t jar_classes_count;
 
-DLLLOCAL extern cmap_t jar_cmap;
+// returns the index entry for the given class or nullptr if not found
+static const jar_class_info_t* find_jar_class(const char* bname) {
+    const jar_class_info_t* end = jar_classes + jar_classes_count;
+    const jar_class_info_t* i = std::lower_bound(jar_classes, end, bname,
+        [](const jar_class_info_t& info, const char* name) -> bool {
+            return strcmp(info.bname, name) < 0;
+        }
+    );
+    return (i != end && !strcmp(i->bname, bname)) ? i : nullptr;
+}
 
 static jbyteArray qore_url_classloader_get_cached_class(JNIEnv* jenv, jclass jcls, jstring bin_name) {
     Env env(jenv);
-    Env::GetStringUtfChars bname(env, bin_name);
+    try {
+        Env::GetStringUtfChars bname(env, bin_name);
 
-    cmap_t::const_iterator i = jar_cmap.find(bname.c_str());
-    if (i == jar_cmap.end()) {
-        //printd(LogLevel, "qore_url_classloader_get_cached_class() '%s' not found\n", bname.c_str());
-        return nullptr;
-    }
+        const jar_class_info_t* i = find_jar_class(bname.c_str());
+        if (!i) {
+            //printd(LogLevel, "qore_url_classloader_get_cached_class() '%s' not found\n", bname.c_str());
+            return nullptr;
+        }
 
-    // decompress class data
-    SimpleRefHolder<BinaryNode> b(new BinaryNode);
-    b->preallocate(i->second.len);
-    unsigned size = i->second.len;
-    int rc = BZ2_bzBuffToBuffDecompress((char*)b->getPtr(), &size, (char*)i->second.byte_code,
-        i->second.compressed_len, 0, 0);
-    assert(!rc);
-    assert(size == i->second.len);
+        // decompress the class data directly into the Java byte array
+        LocalReference<jbyteArray> array = env.newByteArray(i->len).as<jbyteArray>();
+        // initialize the stream before entering the critical region, as inflateInit2() allocates memory; inflate()
+        // does not allocate its window when the output fits in the buffer with Z_FINISH
+        z_stream zs = {};
+        zs.next_in = const_cast<Bytef*>(i->byte_code);
+        zs.avail_in = i->compressed_len;
+        // 16 + MAX_WBITS: expect gzip framing
+        int rc = inflateInit2(&zs, 16 + MAX_WBITS);
+        if (rc == Z_OK) {
+            // the stream is freed even if the array cannot be accessed
+            ON_BLOCK_EXIT(inflateEnd, &zs);
+            Env::PrimitiveArrayCritical pac(env, array);
+            zs.next_out = static_cast<Bytef*>(pac.get());
+            zs.avail_out = i->len;
+            rc = inflate(&zs, Z_FINISH);
+        }
+        if (rc != Z_STREAM_END || zs.total_out != i->len) {
+            QoreStringMaker desc("failed to decompress embedded class '%s': zlib error %d", bname.c_str(), rc);
+            env.throwNew(env.findClass("java/lang/InternalError"), desc.c_str());
+            return nullptr;
+        }
 
-    LocalReference<jbyteArray> array = env.newByteArray(b->size()).as<jbyteArray>();
-    for (jsize j = 0; j < static_cast<jsize>(i->second.len); ++j) {
-        env.setByteArrayElement(array, j, ((const char*)b->getPtr())[j]);
+        //printd(LogLevel, "qore_url_classloader_get_cached_class() FOUND '%s'\n", bname.c_str());
+        return array.release();
+    } catch (jni::Exception& e) {
+        ExceptionSink xsink;
+        e.convert(&xsink);
+        QoreToJava::wrapException(xsink);
+        return nullptr;
     }
-
-    //printd(LogLevel, "qore_url_classloader_get_cached_class() FOUND '%s'\n", bname.c_str());
-    return array.release();
 }
 
 static jobject JNICALL java_class_builder_do_normal_call(JNIEnv* jenv, jclass jcls, jstring mname, jlong qobj,
@@ -1791,6 +1986,9 @@ static GlobalReference<jclass> getPrimitiveClass(Env& env, const char* wrapperNa
 #include "JavaClassJavaClassBuilder_2.inc"
 #include "JavaClassStaticEntry.inc"
 #include "JavaClassQoreJavaApi.inc"
+#include "JavaClassQoreBinaryBuffer.inc"
+#include "JavaClassQoreDataDecoder.inc"
+#include "JavaClassQoreHashProxy.inc"
 #include "JavaClassQoreRelativeTime.inc"
 #include "JavaClassQoreJavaDynamicApi.inc"
 #include "JavaClassHash.inc"
@@ -1887,9 +2085,7 @@ static jbyteArray qore_url_classloader_get_internal_class(JNIEnv* jenv, jclass j
     }
 
     LocalReference<jbyteArray> array = env.newByteArray(i->second.len).as<jbyteArray>();
-    for (jsize j = 0; j < static_cast<jsize>(i->second.len); ++j) {
-        env.setByteArrayElement(array, j, i->second.byte_code[j]);
-    }
+    env.setBytes(array, i->second.byte_code, i->second.len);
 
     //printd(LogLevel, "qore_url_classloader_get_internal_class() FOUND '%s'\n", bname.c_str());
     return array.release();
@@ -1964,6 +2160,37 @@ static JNINativeMethod invocationHandlerNativeMethods[2] = {
     }
 };
 
+static JNINativeMethod qoreBinaryBufferNativeMethods[] = {
+    {
+        const_cast<char*>("release0"),
+        const_cast<char*>("(J)V"),
+        reinterpret_cast<void*>(qore_binary_buffer_release)
+    },
+};
+
+static JNINativeMethod qoreHashProxyNativeMethods[] = {
+    {
+        const_cast<char*>("get0"),
+        const_cast<char*>("(JLjava/lang/String;)Ljava/lang/Object;"),
+        reinterpret_cast<void*>(qore_hash_proxy_get)
+    },
+    {
+        const_cast<char*>("containsKey0"),
+        const_cast<char*>("(JLjava/lang/String;)Z"),
+        reinterpret_cast<void*>(qore_hash_proxy_contains_key)
+    },
+    {
+        const_cast<char*>("keys0"),
+        const_cast<char*>("(J)[Ljava/lang/String;"),
+        reinterpret_cast<void*>(qore_hash_proxy_keys)
+    },
+    {
+        const_cast<char*>("release0"),
+        const_cast<char*>("(J)V"),
+        reinterpret_cast<void*>(qore_hash_proxy_release)
+    },
+};
+
 static JNINativeMethod qoreJavaApiNativeMethods[] = {
     {
         const_cast<char*>("initQore0"),
@@ -2171,9 +2398,7 @@ LocalReference<jclass> Globals::findDefineClass(Env& env, const char* name, jobj
     } else {
         std::vector<jvalue> jargs(2);
         LocalReference<jbyteArray> jbyte_code = env.newByteArray(bufLen).as<jbyteArray>();
-        for (jsize i = 0; i < static_cast<jsize>(bufLen); ++i) {
-            env.setByteArrayElement(jbyte_code, i, ((const char*)buf)[i]);
-        }
+        env.setBytes(jbyte_code, buf, bufLen);
 
         LocalReference<jstring> bname = env.newString(name);
         jargs[0].l = bname;
@@ -2278,6 +2503,9 @@ bool Globals::init() {
         "(Ljava/lang/String;Ljava/lang/String;)Ljava/lang/String;");
     methodSystemGetProperty = env.getStaticMethod(classSystem, "getProperty",
         "(Ljava/lang/String;)Ljava/lang/String;");
+    methodSystemIdentityHashCode = env.getStaticMethod(classSystem, "identityHashCode", "(Ljava/lang/Object;)I");
+    methodSystemArraycopy = env.getStaticMethod(classSystem, "arraycopy",
+        "(Ljava/lang/Object;ILjava/lang/Object;II)V");
     check_java_version();
 
     // check for bootstrap initialization
@@ -2433,6 +2661,22 @@ bool Globals::init() {
     env.registerNatives(classQoreJavaApi, qoreJavaApiNativeMethods,
         sizeof(qoreJavaApiNativeMethods) / sizeof(JNINativeMethod));
     methodQoreJavaApiGetStackTrace = env.getStaticMethod(classQoreJavaApi, "getStackTrace", "()[Ljava/lang/StackTraceElement;");
+    methodQoreJavaApiFlattenMap = env.getStaticMethod(classQoreJavaApi, "flattenMap", "(Ljava/util/Map;)[Ljava/lang/Object;");
+    methodQoreJavaApiPutAll = env.getStaticMethod(classQoreJavaApi, "putAll", "(Ljava/util/Map;[Ljava/lang/Object;)V");
+    methodQoreJavaApiGetUnscaledLong = env.getStaticMethod(classQoreJavaApi, "getUnscaledLong",
+        "(Ljava/math/BigDecimal;)J");
+    methodQoreJavaApiGetUnscaledBytes = env.getStaticMethod(classQoreJavaApi, "getUnscaledBytes",
+        "(Ljava/math/BigDecimal;)[B");
+
+    classByteBuffer = env.findClass("java/nio/ByteBuffer").makeGlobal();
+
+    classQoreBinaryBuffer = findDefineClass(env, "org.qore.jni.QoreBinaryBuffer", nullptr,
+        java_org_qore_jni_QoreBinaryBuffer_class, java_org_qore_jni_QoreBinaryBuffer_class_len).makeGlobal();
+    env.registerNatives(classQoreBinaryBuffer, qoreBinaryBufferNativeMethods,
+        sizeof(qoreBinaryBufferNativeMethods) / sizeof(JNINativeMethod));
+    methodQoreBinaryBufferRegister = env.getStaticMethod(classQoreBinaryBuffer, "register",
+        "(Ljava/nio/ByteBuffer;J)Ljava/nio/ByteBuffer;");
+    methodQoreBinaryBufferStopCleaner = env.getStaticMethod(classQoreBinaryBuffer, "stopCleaner", "()V");
 
     classProxy = env.findClass("java/lang/reflect/Proxy").makeGlobal();
     methodProxyNewProxyInstance = env.getStaticMethod(classProxy, "newProxyInstance",
@@ -2443,10 +2687,12 @@ bool Globals::init() {
     methodThreadGetContextClassLoader = env.getMethod(classThread, "getContextClassLoader", "()Ljava/lang/ClassLoader;");
 
     classHashMap = env.findClass("java/util/HashMap").makeGlobal();
+    ctorHashMapSized = env.getMethod(classHashMap, "<init>", "(I)V");
 
     classHash = findDefineClass(env, "org.qore.jni.Hash", nullptr, java_org_qore_jni_Hash_class,
         java_org_qore_jni_Hash_class_len).makeGlobal();
     ctorHash = env.getMethod(classHash, "<init>", "()V");
+    ctorHashSized = env.getMethod(classHash, "<init>", "(I)V");
     methodHashPut = env.getMethod(classHash, "put", "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
 
     findDefineClass(env, "org.qore.jni.Hash$1", nullptr, java_org_qore_jni_Hash_1_class,
@@ -2470,12 +2716,29 @@ bool Globals::init() {
     findDefineClass(env, "org.qore.jni.Hash$10", nullptr, java_org_qore_jni_Hash_10_class,
         java_org_qore_jni_Hash_10_class_len).makeGlobal();
 
+    classQoreDataDecoder = findDefineClass(env, "org.qore.jni.QoreDataDecoder", nullptr,
+        java_org_qore_jni_QoreDataDecoder_class, java_org_qore_jni_QoreDataDecoder_class_len).makeGlobal();
+    methodQoreDataDecoderDecode = env.getStaticMethod(classQoreDataDecoder, "decode",
+        "(Ljava/nio/ByteBuffer;[Ljava/lang/Object;)Ljava/lang/Object;");
+
+    classQoreHashProxy = findDefineClass(env, "org.qore.jni.QoreHashProxy", nullptr,
+        java_org_qore_jni_QoreHashProxy_class, java_org_qore_jni_QoreHashProxy_class_len).makeGlobal();
+    env.registerNatives(classQoreHashProxy, qoreHashProxyNativeMethods,
+        sizeof(qoreHashProxyNativeMethods) / sizeof(JNINativeMethod));
+    ctorQoreHashProxy = env.getMethod(classQoreHashProxy, "<init>", "(JI)V");
+    methodQoreHashProxyGetHashPtr = env.getMethod(classQoreHashProxy, "getHashPtr", "()J");
+    methodQoreHashProxyStopCleaner = env.getStaticMethod(classQoreHashProxy, "stopCleaner", "()V");
+
     classMap = env.findClass("java/util/Map").makeGlobal();
     methodMapEntrySet = env.getMethod(classMap, "entrySet", "()Ljava/util/Set;");
+    methodMapGet = env.getMethod(classMap, "get", "(Ljava/lang/Object;)Ljava/lang/Object;");
+    methodMapContainsKey = env.getMethod(classMap, "containsKey", "(Ljava/lang/Object;)Z");
+    methodMapSize = env.getMethod(classMap, "size", "()I");
 
     classList = env.findClass("java/util/List").makeGlobal();
     methodListSize = env.getMethod(classList, "size", "()I");
     methodListGet = env.getMethod(classList, "get", "(I)Ljava/lang/Object;");
+    methodListToArray = env.getMethod(classList, "toArray", "()[Ljava/lang/Object;");
 
     classArrayList = env.findClass("java/util/ArrayList").makeGlobal();
     ctorArrayList = env.getMethod(classArrayList, "<init>", "()V");
@@ -2499,6 +2762,19 @@ bool Globals::init() {
     classZonedDateTime = env.findClass("java/time/ZonedDateTime").makeGlobal();
     methodZonedDateTimeParse = env.getStaticMethod(classZonedDateTime, "parse", "(Ljava/lang/CharSequence;)Ljava/time/ZonedDateTime;");
     methodZonedDateTimeToString = env.getMethod(classZonedDateTime, "toString", "()Ljava/lang/String;");
+    methodZonedDateTimeOfInstant = env.getStaticMethod(classZonedDateTime, "ofInstant",
+        "(Ljava/time/Instant;Ljava/time/ZoneId;)Ljava/time/ZonedDateTime;");
+    methodZonedDateTimeToEpochSecond = env.getMethod(classZonedDateTime, "toEpochSecond", "()J");
+    methodZonedDateTimeGetNano = env.getMethod(classZonedDateTime, "getNano", "()I");
+    methodZonedDateTimeGetOffset = env.getMethod(classZonedDateTime, "getOffset", "()Ljava/time/ZoneOffset;");
+
+    classInstant = env.findClass("java/time/Instant").makeGlobal();
+    methodInstantOfEpochSecond = env.getStaticMethod(classInstant, "ofEpochSecond", "(JJ)Ljava/time/Instant;");
+
+    classZoneOffset = env.findClass("java/time/ZoneOffset").makeGlobal();
+    methodZoneOffsetOfTotalSeconds = env.getStaticMethod(classZoneOffset, "ofTotalSeconds",
+        "(I)Ljava/time/ZoneOffset;");
+    methodZoneOffsetGetTotalSeconds = env.getMethod(classZoneOffset, "getTotalSeconds", "()I");
 
     classQoreRelativeTime = findDefineClass(env, "org.qore.jni.QoreRelativeTime", nullptr,
         java_org_qore_jni_QoreRelativeTime_class, java_org_qore_jni_QoreRelativeTime_class_len).makeGlobal();
@@ -2514,27 +2790,40 @@ bool Globals::init() {
     classBigDecimal = env.findClass("java/math/BigDecimal").makeGlobal();
     ctorBigDecimal = env.getMethod(classBigDecimal, "<init>", "(Ljava/lang/String;)V");
     methodBigDecimalToString = env.getMethod(classBigDecimal, "toString", "()Ljava/lang/String;");
+    ctorBigDecimalBigIntegerInt = env.getMethod(classBigDecimal, "<init>", "(Ljava/math/BigInteger;I)V");
+    methodBigDecimalValueOf = env.getStaticMethod(classBigDecimal, "valueOf", "(JI)Ljava/math/BigDecimal;");
+    methodBigDecimalScale = env.getMethod(classBigDecimal, "scale", "()I");
+
+    classBigInteger = env.findClass("java/math/BigInteger").makeGlobal();
+    ctorBigIntegerSignumMagnitude = env.getMethod(classBigInteger, "<init>", "(I[B)V");
 
     classArrays = env.findClass("java/util/Arrays").makeGlobal();
     methodArraysToString = env.getStaticMethod(classArrays, "toString", "([Ljava/lang/Object;)Ljava/lang/String;");
     methodArraysDeepToString = env.getStaticMethod(classArrays, "deepToString", "([Ljava/lang/Object;)Ljava/lang/String;");
+    methodArraysFill = env.getStaticMethod(classArrays, "fill", "([Ljava/lang/Object;Ljava/lang/Object;)V");
 
     classBoolean = env.findClass("java/lang/Boolean").makeGlobal();
     ctorBoolean = env.getMethod(classBoolean, "<init>", "(Z)V");
+    methodBooleanValueOf = env.getStaticMethod(classBoolean, "valueOf", "(Z)Ljava/lang/Boolean;");
     methodBooleanBooleanValue = env.getMethod(classBoolean, "booleanValue", "()Z");
 
     classInteger = env.findClass("java/lang/Integer").makeGlobal();
     ctorInteger = env.getMethod(classInteger, "<init>", "(I)V");
+    methodIntegerValueOf = env.getStaticMethod(classInteger, "valueOf", "(I)Ljava/lang/Integer;");
     methodIntegerIntValue = env.getMethod(classInteger, "intValue", "()I");
 
     classDouble = env.findClass("java/lang/Double").makeGlobal();
     ctorDouble = env.getMethod(classDouble, "<init>", "(D)V");
+    methodDoubleValueOf = env.getStaticMethod(classDouble, "valueOf", "(D)Ljava/lang/Double;");
     methodDoubleDoubleValue = env.getMethod(classDouble, "doubleValue", "()D");
 
     classLong = env.findClass("java/lang/Long").makeGlobal();
     ctorLong = env.getMethod(classLong, "<init>", "(J)V");
+    methodLongValueOf = env.getStaticMethod(classLong, "valueOf", "(J)Ljava/lang/Long;");
     methodLongLongValue = env.getMethod(classLong, "longValue", "()J");
 
+    initBoxCaches(env);
+
     classShort = env.findClass("java/lang/Short").makeGlobal();
     ctorShort = env.getMethod(classShort, "<init>", "(S)V");
     methodShortShortValue = env.getMethod(classShort, "shortValue", "()S");
@@ -2583,9 +2872,7 @@ bool Globals::init() {
             std::vector<jvalue> jargs(2);
             LocalReference<jbyteArray> jbyte_code =
                 env.newByteArray(java_org_qore_jni_JavaClassBuilder_1_class_len).as<jbyteArray>();
-            for (jsize i = 0; i < static_cast<jsize>(java_org_qore_jni_JavaClassBuilder_1_class_len); ++i) {
-                env.setByteArrayElement(jbyte_code, i, ((const char*)java_org_qore_jni_JavaClassBuilder_1_class)[i]);
-            }
+            env.setBytes(jbyte_code, java_org_qore_jni_JavaClassBuilder_1_class, java_org_qore_jni_JavaClassBuilder_1_class_len);
             LocalReference<jstring> bname = env.newString("org.qore.jni.JavaClassBuilder$1");
             jargs[0].l = bname;
             jargs[1].l = jbyte_code;
@@ -2597,9 +2884,7 @@ bool Globals::init() {
             std::vector<jvalue> jargs(2);
             LocalReference<jbyteArray> jbyte_code =
                 env.newByteArray(java_org_qore_jni_JavaClassBuilder_class_len).as<jbyteArray>();
-            for (jsize i = 0; i < static_cast<jsize>(java_org_qore_jni_JavaClassBuilder_class_len); ++i) {
-                env.setByteArrayElement(jbyte_code, i, ((const char*)java_org_qore_jni_JavaClassBuilder_class)[i]);
-            }
+            env.setBytes(jbyte_code, java_org_qore_jni_JavaClassBuilder_class, java_org_qore_jni_JavaClassBuilder_class_len);
             LocalReference<jstring> bname = env.newString("org.qore.jni.JavaClassBuilder");
             jargs[0].l = bname;
             jargs[1].l = jbyte_code;
@@ -2658,6 +2943,14 @@ bool Globals::init() {
         "(Ljava/lang/String;)Lnet/bytebuddy/description/type/TypeDescription;");
     methodJavaClassBuilderFindBaseClassMethodConflict = env.getStaticMethod(classJavaClassBuilder,
         "findBaseClassMethodConflict", "(Ljava/lang/Class;Ljava/lang/String;Ljava/util/List;Z)Z");
+    methodJavaClassBuilderLoadCachedByteCode = env.getStaticMethod(classJavaClassBuilder, "loadCachedByteCode",
+        "(Ljava/lang/String;[B)[Ljava/lang/Object;");
+    methodJavaClassBuilderStoreCachedByteCode = env.getStaticMethod(classJavaClassBuilder, "storeCachedByteCode",
+        "(Ljava/lang/String;[B[Ljava/lang/String;[J[B)V");
+    methodJavaClassBuilderRelocateByteCode = env.getStaticMethod(classJavaClassBuilder, "relocateByteCode",
+        "([B[I[J[J)[B");
+    methodJavaClassBuilderGetByteCodeCacheEnvironment = env.getStaticMethod(classJavaClassBuilder,
+        "getByteCodeCacheEnvironment", "(Ljava/lang/ClassLoader;Ljava/lang/Class;)Ljava/lang/String;");
 
     classGraphicsEnvironment = env.findClass("java/awt/GraphicsEnvironment").makeGlobal();;
     methodGraphicsEnvironmentIsHeadless = env.getStaticMethod(classGraphicsEnvironment, "isHeadless", "()Z");
@@ -2672,6 +2965,36 @@ void Globals::bootstrapInitDone() {
 }
 
 void Globals::cleanup() {
+    // binary values referenced by direct buffers cannot be released once the module has been unloaded
+    if (classQoreBinaryBuffer) {
+        Env env;
+        try {
+            env.callStaticVoidMethod(classQoreBinaryBuffer, methodQoreBinaryBufferStopCleaner, nullptr);
+        } catch (jni::JavaException& e) {
+            e.ignore();
+        }
+    }
+    // the same applies to hashes referenced by lazy hash proxies
+    if (classQoreHashProxy) {
+        Env env;
+        try {
+            env.callStaticVoidMethod(classQoreHashProxy, methodQoreHashProxyStopCleaner, nullptr);
+        } catch (jni::JavaException& e) {
+            e.ignore();
+        }
+    }
+
+    JavaToQore::clearValueKindCache();
+    QoreToJava::clearMapTargetCache();
+    QoreToJava::clearKeyCache();
+    QoreToJava::clearZoneOffsetCache();
+
+    // delete cached boxed values
+    booleanTrue = nullptr;
+    booleanFalse = nullptr;
+    integerCache.clear();
+    longCache.clear();
+
     // delete classes
     classThrowable = nullptr;
     classStackTraceElement = nullptr;
@@ -2711,6 +3034,10 @@ void Globals::cleanup() {
     classGraphicsEnvironment = nullptr;
     classThread = nullptr;
     classHashMap = nullptr;
+    classByteBuffer = nullptr;
+    classQoreBinaryBuffer = nullptr;
+    classQoreDataDecoder = nullptr;
+    classQoreHashProxy = nullptr;
     classHash = nullptr;
     classMap = nullptr;
     classList = nullptr;
@@ -2719,8 +3046,11 @@ void Globals::cleanup() {
     classEntry = nullptr;
     classIterator = nullptr;
     classZonedDateTime = nullptr;
+    classInstant = nullptr;
+    classZoneOffset = nullptr;
     classQoreRelativeTime = nullptr;
     classBigDecimal = nullptr;
+    classBigInteger = nullptr;
     classArrays = nullptr;
     classBoolean = nullptr;
     classInteger = nullptr;
@@ -2771,6 +3101,83 @@ Type Globals::getType(jclass cls) {
     return Type::Reference;
 }
 
+void Globals::initBoxCaches(Env& env) {
+    booleanTrue = env.getStaticObjectField(classBoolean, env.getStaticField(classBoolean, "TRUE",
+        "Ljava/lang/Boolean;")).makeGlobal();
+    booleanFalse = env.getStaticObjectField(classBoolean, env.getStaticField(classBoolean, "FALSE",
+        "Ljava/lang/Boolean;")).makeGlobal();
+
+    integerCache.clear();
+    longCache.clear();
+    if (jni_box_cache_high < BoxCacheLow) {
+        return;
+    }
+    size_t size = jni_box_cache_high - BoxCacheLow + 1;
+    integerCache.reserve(size);
+    longCache.reserve(size);
+    jvalue arg;
+    for (int i = BoxCacheLow; i <= jni_box_cache_high; ++i) {
+        arg.i = i;
+        integerCache.emplace_back(env.callStaticObjectMethod(classInteger, methodIntegerValueOf, &arg).makeGlobal());
+        arg.j = i;
+        longCache.emplace_back(env.callStaticObjectMethod(classLong, methodLongValueOf, &arg).makeGlobal());
+    }
+}
+
+LocalReference<jobject> Globals::boxBoolean(Env& env, bool v) {
+    return env.newLocalRef<jobject>(v ? booleanTrue : booleanFalse);
+}
+
+LocalReference<jobject> Globals::boxInteger(Env& env, jint v) {
+    if (v >= BoxCacheLow && v <= jni_box_cache_high) {
+        return env.newLocalRef<jobject>(integerCache[v - BoxCacheLow]);
+    }
+    jvalue arg;
+    arg.i = v;
+    return env.callStaticObjectMethod(classInteger, methodIntegerValueOf, &arg);
+}
+
+LocalReference<jobject> Globals::boxLong(Env& env, jlong v) {
+    if (v >= BoxCacheLow && v <= jni_box_cache_high) {
+        return env.newLocalRef<jobject>(longCache[v - BoxCacheLow]);
+    }
+    jvalue arg;
+    arg.j = v;
+    return env.callStaticObjectMethod(classLong, methodLongValueOf, &arg);
+}
+
+LocalReference<jobject> Globals::boxDouble(Env& env, jdouble v) {
+    jvalue arg;
+    arg.d = v;
+    return env.callStaticObjectMethod(classDouble, methodDoubleValueOf, &arg);
+}
+
+TargetKind Globals::getTargetKind(jclass cls) {
+    if (!cls) {
+        return TargetKind::None;
+    }
+    Env env;
+    if (env.isSameObject(cls, classObject)) {
+        return TargetKind::Object;
+    }
+    if (env.isSameObject(cls, classString)) {
+        return TargetKind::String;
+    }
+    if (env.isSameObject(cls, classBoolean) || env.isSameObject(cls, classPrimitiveBoolean)) {
+        return TargetKind::Boolean;
+    }
+    if (env.isSameObject(cls, classInteger) || env.isSameObject(cls, classPrimitiveInt)) {
+        return TargetKind::Integer;
+    }
+    if (env.isSameObject(cls, classLong) || env.isSameObject(cls, classPrimitiveLong)) {
+        return TargetKind::Long;
+    }
+    if (env.isSameObject(cls, classDouble) || env.isSameObject(cls, classPrimitiveDouble)) {
+        return TargetKind::Double;
+    }
+    return TargetKind::Other;
+}
+
 jlong Globals::getContextProgram(jobject new_syscl, bool& created) {
     created = false;
 
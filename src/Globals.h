@@ -31,6 +31,8 @@
 #ifndef QORE_JNI_GLOBALS_H_
 #define QORE_JNI_GLOBALS_H_
 
+#include <vector>
+
 #include "GlobalReference.h"
 #include "Env.h"
 
@@ -42,7 +44,31 @@ enum class Type {
     Void, Boolean, Byte, Char, Short, Int, Long, Float, Double, Reference
 };
 
+//! Classification of the target class of a conversion to a Java object
+/** determined once per target class so that conversions do not need to check the class identity for each value
+*/
+enum class TargetKind {
+    //! no target class
+    None,
+    //! java.lang.Object; any value is converted with its default mapping
+    Object,
+    //! java.lang.Boolean or boolean
+    Boolean,
+    //! java.lang.Integer or int
+    Integer,
+    //! java.lang.Long or long
+    Long,
+    //! java.lang.Double or double
+    Double,
+    //! java.lang.String
+    String,
+    //! any other class
+    Other
+};
+
 DLLLOCAL extern bool jni_qore_init;
+// the highest integer value for which boxed Integer and Long objects are cached
+DLLLOCAL extern int jni_box_cache_high;
 DLLLOCAL void jni_delete_pgm(ExceptionSink& xsink);
 DLLLOCAL QoreProgram* jni_get_create_program(Env& env);
 
@@ -72,6 +98,8 @@ public:
     DLLLOCAL static GlobalReference<jclass> classSystem;                          // java.lang.System
     DLLLOCAL static jmethodID methodSystemSetProperty;                            // String System.setProperty()
     DLLLOCAL static jmethodID methodSystemGetProperty;                            // String System.getProperty()
+    DLLLOCAL static jmethodID methodSystemIdentityHashCode;                       // int System.identityHashCode(Object)
+    DLLLOCAL static jmethodID methodSystemArraycopy;                              // void System.arraycopy(Object, int, Object, int, int)
 
     DLLLOCAL static GlobalReference<jclass> classObject;                          // java.lang.Object
     DLLLOCAL static jmethodID methodObjectClone;                                  // Object Object.clone()
@@ -140,6 +168,10 @@ public:
 
     DLLLOCAL static GlobalReference<jclass> classQoreJavaApi;                     // org.qore.jni.QoreJavaApi
     DLLLOCAL static jmethodID methodQoreJavaApiGetStackTrace;                     // StackTraceElement[] getStackTrace()
+    DLLLOCAL static jmethodID methodQoreJavaApiFlattenMap;                        // Object[] flattenMap(Map)
+    DLLLOCAL static jmethodID methodQoreJavaApiPutAll;                            // void putAll(Map, Object[])
+    DLLLOCAL static jmethodID methodQoreJavaApiGetUnscaledLong;                   // long getUnscaledLong(BigDecimal)
+    DLLLOCAL static jmethodID methodQoreJavaApiGetUnscaledBytes;                  // byte[] getUnscaledBytes(BigDecimal)
 
     DLLLOCAL static GlobalReference<jclass> classQoreExceptionWrapper;            // org.qore.jni.QoreExceptionWrapper
     DLLLOCAL static jmethodID ctorQoreExceptionWrapper;                           // QoreExceptionWrapper(long)
@@ -206,6 +238,10 @@ public:
     DLLLOCAL static jmethodID methodJavaClassBuilderGetTypeDescriptionCls;        // static TypeDescription getTypeDescription(Class<?>)
     DLLLOCAL static jmethodID methodJavaClassBuilderGetTypeDescriptionStr;        // static TypeDescription getTypeDescription(String)
     DLLLOCAL static jmethodID methodJavaClassBuilderFindBaseClassMethodConflict;  // static boolean findBaseClassMethodConflict(Class<?>, String, List<TypeDescription>, boolean)
+    DLLLOCAL static jmethodID methodJavaClassBuilderLoadCachedByteCode;           // static Object[] loadCachedByteCode(String, byte[])
+    DLLLOCAL static jmethodID methodJavaClassBuilderStoreCachedByteCode;          // static void storeCachedByteCode(String, byte[], String[], long[], byte[])
+    DLLLOCAL static jmethodID methodJavaClassBuilderRelocateByteCode;             // static byte[] relocateByteCode(byte[], int[], long[], long[])
+    DLLLOCAL static jmethodID methodJavaClassBuilderGetByteCodeCacheEnvironment;  // static String getByteCodeCacheEnvironment(ClassLoader, Class<?>)
 
     // to check for headless AWT to avoid importing classes that cannot be initialized when headless
     DLLLOCAL static GlobalReference<jclass> classGraphicsEnvironment;             // java.awt.GraphicsEnvironment
@@ -215,18 +251,38 @@ public:
     DLLLOCAL static jmethodID methodThreadCurrentThread;                          // Thread Thread.currentThread()
     DLLLOCAL static jmethodID methodThreadGetContextClassLoader;                  // ClassLoader Thread.getContextClassLoader()
 
+    DLLLOCAL static GlobalReference<jclass> classByteBuffer;                      // java.nio.ByteBuffer
+
+    DLLLOCAL static GlobalReference<jclass> classQoreBinaryBuffer;                // org.qore.jni.QoreBinaryBuffer
+    DLLLOCAL static jmethodID methodQoreBinaryBufferRegister;                     // ByteBuffer register(ByteBuffer, long)
+    DLLLOCAL static jmethodID methodQoreBinaryBufferStopCleaner;                  // void stopCleaner()
+
     DLLLOCAL static GlobalReference<jclass> classHashMap;                         // java.util.HashMap
+    DLLLOCAL static jmethodID ctorHashMapSized;                                   // HashMap(int)
 
     DLLLOCAL static GlobalReference<jclass> classHash;                            // org.qore.jni.Hash
     DLLLOCAL static jmethodID ctorHash;                                           // Hash()
+    DLLLOCAL static jmethodID ctorHashSized;                                      // Hash(int)
     DLLLOCAL static jmethodID methodHashPut;                                      // Object Hash.put(Object K, Object V)
 
+    DLLLOCAL static GlobalReference<jclass> classQoreDataDecoder;                 // org.qore.jni.QoreDataDecoder
+    DLLLOCAL static jmethodID methodQoreDataDecoderDecode;                        // Object decode(ByteBuffer, Object[])
+
+    DLLLOCAL static GlobalReference<jclass> classQoreHashProxy;                   // org.qore.jni.QoreHashProxy
+    DLLLOCAL static jmethodID ctorQoreHashProxy;                                  // QoreHashProxy(long, int)
+    DLLLOCAL static jmethodID methodQoreHashProxyGetHashPtr;                      // long getHashPtr()
+    DLLLOCAL static jmethodID methodQoreHashProxyStopCleaner;                     // void stopCleaner()
+
     DLLLOCAL static GlobalReference<jclass> classMap;                             // java.util.Map
     DLLLOCAL static jmethodID methodMapEntrySet;                                  // Set<Map.Entry<K,V>> Map.entrySet()
+    DLLLOCAL static jmethodID methodMapGet;                                       // V Map.get(Object key)
+    DLLLOCAL static jmethodID methodMapContainsKey;                               // boolean Map.containsKey(Object key)
+    DLLLOCAL static jmethodID methodMapSize;                                      // int Map.size()
 
     DLLLOCAL static GlobalReference<jclass> classList;                            // java.util.List
     DLLLOCAL static jmethodID methodListSize;                                     // int List.size()
     DLLLOCAL static jmethodID methodListGet;                                      // Object List.get(int index)
+    DLLLOCAL static jmethodID methodListToArray;                                  // Object[] List.toArray()
 
     DLLLOCAL static GlobalReference<jclass> classArrayList;                       // java.util.ArrayList
     DLLLOCAL static jmethodID ctorArrayList;                                      // ArrayList()
@@ -250,6 +306,17 @@ public:
     DLLLOCAL static GlobalReference<jclass> classZonedDateTime;                   // java.time.ZonedDateTime
     DLLLOCAL static jmethodID methodZonedDateTimeParse;                           // ZonedDateTime.parse()
     DLLLOCAL static jmethodID methodZonedDateTimeToString;                        // ZonedDateTime.toString()
+    DLLLOCAL static jmethodID methodZonedDateTimeOfInstant;                       // ZonedDateTime.ofInstant(Instant, ZoneId)
+    DLLLOCAL static jmethodID methodZonedDateTimeToEpochSecond;                   // long ZonedDateTime.toEpochSecond()
+    DLLLOCAL static jmethodID methodZonedDateTimeGetNano;                         // int ZonedDateTime.getNano()
+    DLLLOCAL static jmethodID methodZonedDateTimeGetOffset;                       // ZoneOffset ZonedDateTime.getOffset()
+
+    DLLLOCAL static GlobalReference<jclass> classInstant;                         // java.time.Instant
+    DLLLOCAL static jmethodID methodInstantOfEpochSecond;                         // Instant.ofEpochSecond(long, long)
+
+    DLLLOCAL static GlobalReference<jclass> classZoneOffset;                      // java.time.ZoneOffset
+    DLLLOCAL static jmethodID methodZoneOffsetOfTotalSeconds;                     // ZoneOffset.ofTotalSeconds(int)
+    DLLLOCAL static jmethodID methodZoneOffsetGetTotalSeconds;                    // int ZoneOffset.getTotalSeconds()
 
     DLLLOCAL static GlobalReference<jclass> classQoreRelativeTime;                // org.qore.jni.QoreRelativeTime
     DLLLOCAL static jmethodID ctorQoreRelativeTime;                               // QoreRelativeTime(int, int, int, int, int, int, int)
@@ -264,21 +331,31 @@ public:
     DLLLOCAL static GlobalReference<jclass> classBigDecimal;                      // java.math.BigDecimal
     DLLLOCAL static jmethodID ctorBigDecimal;                                     // BigDecimal(String)
     DLLLOCAL static jmethodID methodBigDecimalToString;                           // BigDecimal.toString()
+    DLLLOCAL static jmethodID ctorBigDecimalBigIntegerInt;                        // BigDecimal(BigInteger, int)
+    DLLLOCAL static jmethodID methodBigDecimalValueOf;                            // BigDecimal.valueOf(long, int)
+    DLLLOCAL static jmethodID methodBigDecimalScale;                              // int BigDecimal.scale()
+
+    DLLLOCAL static GlobalReference<jclass> classBigInteger;                      // java.math.BigInteger
+    DLLLOCAL static jmethodID ctorBigIntegerSignumMagnitude;                      // BigInteger(int, byte[])
 
     DLLLOCAL static GlobalReference<jclass> classArrays;                          // java.util.Arrays
     DLLLOCAL static jmethodID methodArraysToString;                               // Arrays.toString()
     DLLLOCAL static jmethodID methodArraysDeepToString;                           // Arrays.deepToString()
+    DLLLOCAL static jmethodID methodArraysFill;                                   // void Arrays.fill(Object[], Object)
 
     DLLLOCAL static GlobalReference<jclass> classBoolean;                         // java.lang.Boolean
     DLLLOCAL static jmethodID ctorBoolean;                                        // Boolean(boolean)
+    DLLLOCAL static jmethodID methodBooleanValueOf;                               // static Boolean Boolean.valueOf(boolean)
     DLLLOCAL static jmethodID methodBooleanBooleanValue;                          // boolean Boolean.booleanValue()
 
     DLLLOCAL static GlobalReference<jclass> classInteger;                         // java.lang.Integer
     DLLLOCAL static jmethodID ctorInteger;                                        // Integer(int)
+    DLLLOCAL static jmethodID methodIntegerValueOf;                               // static Integer Integer.valueOf(int)
     DLLLOCAL static jmethodID methodIntegerIntValue;                              // int Integer.intValue()
 
     DLLLOCAL static GlobalReference<jclass> classLong;                            // java.lang.Long
     DLLLOCAL static jmethodID ctorLong;                                           // Long(long)
+    DLLLOCAL static jmethodID methodLongValueOf;                                  // static Long Long.valueOf(long)
     DLLLOCAL static jmethodID methodLongLongValue;                                // long Long.longValue()
 
     DLLLOCAL static GlobalReference<jclass> classShort;                           // java.lang.Short
@@ -291,6 +368,7 @@ public:
 
     DLLLOCAL static GlobalReference<jclass> classDouble;                          // java.lang.Double
     DLLLOCAL static jmethodID ctorDouble;                                         // Double(double)
+    DLLLOCAL static jmethodID methodDoubleValueOf;                                // static Double Double.valueOf(double)
     DLLLOCAL static jmethodID methodDoubleDoubleValue;                            // double Double.doubleValue()
 
     DLLLOCAL static GlobalReference<jclass> classFloat;                           // java.lang.Float
@@ -308,6 +386,18 @@ public:
 
     DLLLOCAL static GlobalReference<jclass> getQoreJavaClassBase(Env& env, jobject classLoader);
 
+    //! Returns a local reference to a java.lang.Boolean for the given value
+    DLLLOCAL static LocalReference<jobject> boxBoolean(Env& env, bool v);
+
+    //! Returns a local reference to a java.lang.Integer for the given value; small values are taken from a cache
+    DLLLOCAL static LocalReference<jobject> boxInteger(Env& env, jint v);
+
+    //! Returns a local reference to a java.lang.Long for the given value; small values are taken from a cache
+    DLLLOCAL static LocalReference<jobject> boxLong(Env& env, jlong v);
+
+    //! Returns a local reference to a java.lang.Double for the given value
+    DLLLOCAL static LocalReference<jobject> boxDouble(Env& env, jdouble v);
+
     // returns true if this is a Java bootstrap init
     DLLLOCAL static bool init();
 
@@ -315,6 +405,7 @@ public:
 
     DLLLOCAL static void cleanup();
     DLLLOCAL static Type getType(jclass cls);
+    DLLLOCAL static TargetKind getTargetKind(jclass cls);
 
     DLLLOCAL static jlong getContextProgram(jobject new_syscl, bool& created);
     DLLLOCAL static QoreProgram* createJavaContextProgram();
@@ -346,7 +437,19 @@ private:
 
     DLLLOCAL static bool already_initialized;
 
+    // lowest value in the Integer and Long box caches; matches the lower bound of the JVM's own caches
+    static constexpr int BoxCacheLow = -128;
+
+    // cached Boolean.TRUE and Boolean.FALSE
+    DLLLOCAL static GlobalReference<jobject> booleanTrue;
+    DLLLOCAL static GlobalReference<jobject> booleanFalse;
+    // cached Integer and Long objects for BoxCacheLow to jni_box_cache_high inclusive
+    DLLLOCAL static std::vector<GlobalReference<jobject>> integerCache;
+    DLLLOCAL static std::vector<GlobalReference<jobject>> longCache;
+
     DLLLOCAL static void defineQoreURLClassLoader(Env& env);
+
+    DLLLOCAL static void initBoxCaches(Env& env);
 };
 
 class QoreJniStackLocationHelper : public QoreExternalRuntimeStackLocationHelper {
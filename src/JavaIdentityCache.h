@@ -0,0 +1,206 @@
+//--------------------------------------------------------------------*- C++ -*-
+//
+//  Qore Programming Language
+//
+//  Copyright (C) 2016 - 2021 Qore Technologies, s.r.o.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//------------------------------------------------------------------------------
+///
+/// \file
+/// \brief Defines the JavaIdentityCache class.
+///
+//------------------------------------------------------------------------------
+#ifndef QORE_JNI_JAVAIDENTITYCACHE_H_
+#define QORE_JNI_JAVAIDENTITYCACHE_H_
+
+#include <qore/Qore.h>
+#include <jni.h>
+
+#include <iterator>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "Env.h"
+#include "Globals.h"
+
+namespace jni {
+
+/**
+ * \brief A bounded cache of the Qore objects wrapping Java objects.
+ *
+ * Lets the same Java object be returned to Qore as the same Qore object, so that repeated round trips do not
+ * create new wrappers and global references, and so that the wrappers compare equal.  Java objects are tracked
+ * with weak global references, and the least recently used entries are evicted when the cache is full.
+ *
+ * The cache holds strong references to the Qore wrappers, so wrappers and their Java objects stay alive until they
+ * are evicted; the Qore API has no way to turn a weak object reference into a strong one atomically with the
+ * destruction of the object.
+ */
+class JavaIdentityCache {
+public:
+    /**
+     * \brief Creates the cache.
+     * \param max_size the maximum number of cached objects
+     */
+    DLLLOCAL JavaIdentityCache(size_t max_size) : max_size(max_size) {
+    }
+
+    /**
+     * \brief Returns the identity hash code for the given object.
+     * \param env the JNI environment
+     * \param obj the Java object
+     * \return the identity hash code
+     * \throws JavaException if the call fails
+     */
+    DLLLOCAL static jint getHash(Env& env, jobject obj) {
+        jvalue jarg;
+        jarg.l = obj;
+        return env.callStaticIntMethod(Globals::classSystem, Globals::methodSystemIdentityHashCode, &jarg);
+    }
+
+    /**
+     * \brief Returns the cached wrapper for the given Java object.
+     * \param env the JNI environment
+     * \param obj the Java object
+     * \param hash the identity hash code of \a obj
+     * \return a new reference to the cached Qore object or nullptr if the object is not cached
+     */
+    DLLLOCAL QoreObject* get(Env& env, jobject obj, jint hash) {
+        std::vector<Entry> evicted;
+        QoreObject* rv = nullptr;
+        {
+            AutoLocker al(lck);
+            auto range = index.equal_range(hash);
+            for (auto i = range.first; i != range.second; ++i) {
+                lru_t::iterator li = i->second;
+                if (!env.isSameObject(li->jobj, obj)) {
+                    continue;
+                }
+                // the wrapper may have been deleted explicitly
+                if (!li->obj->isValid()) {
+                    evicted.push_back(*li);
+                    lru.erase(li);
+                    index.erase(i);
+                    break;
+                }
+                // mark as most recently used
+                lru.splice(lru.begin(), lru, li);
+                rv = li->obj;
+                rv->ref();
+                break;
+            }
+        }
+        release(env, evicted);
+        return rv;
+    }
+
+    /**
+     * \brief Adds a wrapper to the cache.
+     * \param env the JNI environment
+     * \param obj the Java object
+     * \param hash the identity hash code of \a obj
+     * \param qobj the Qore object wrapping \a obj; the cache takes a new reference
+     */
+    DLLLOCAL void add(Env& env, jobject obj, jint hash, QoreObject* qobj) {
+        Entry entry = {hash, env.newWeakGlobalRef(obj), qobj};
+        qobj->ref();
+
+        std::vector<Entry> evicted;
+        {
+            AutoLocker al(lck);
+            lru.push_front(entry);
+            index.insert(index_t::value_type(hash, lru.begin()));
+
+            while (lru.size() > max_size) {
+                evictLast(evicted);
+            }
+        }
+        release(env, evicted);
+    }
+
+    /**
+     * \brief Removes all entries from the cache.
+     * \param env the JNI environment
+     */
+    DLLLOCAL void clear(Env& env) {
+        std::vector<Entry> evicted;
+        {
+            AutoLocker al(lck);
+            evicted.assign(lru.begin(), lru.end());
+            lru.clear();
+            index.clear();
+        }
+        release(env, evicted);
+    }
+
+private:
+    struct Entry {
+        //! the identity hash code of the Java object
+        jint hash;
+        //! weak global reference to the Java object
+        jweak jobj;
+        //! the Qore wrapper; the cache holds a reference
+        QoreObject* obj;
+    };
+
+    //! entries ordered from most to least recently used
+    typedef std::list<Entry> lru_t;
+    //! identity hash codes to entries
+    typedef std::unordered_multimap<jint, lru_t::iterator> index_t;
+
+    QoreThreadLock lck;
+    size_t max_size;
+    lru_t lru;
+    index_t index;
+
+    //! removes the least recently used entry; the lock must be held
+    DLLLOCAL void evictLast(std::vector<Entry>& evicted) {
+        lru_t::iterator li = std::prev(lru.end());
+        auto range = index.equal_range(li->hash);
+        for (auto i = range.first; i != range.second; ++i) {
+            if (i->second == li) {
+                index.erase(i);
+                break;
+            }
+        }
+        evicted.push_back(*li);
+        lru.erase(li);
+    }
+
+    //! releases evicted entries; must be called without the lock held, as releasing a wrapper can run Qore code
+    DLLLOCAL static void release(Env& env, std::vector<Entry>& evicted) {
+        if (evicted.empty()) {
+            return;
+        }
+        ExceptionSink xsink;
+        for (auto& i : evicted) {
+            env.deleteWeakGlobalRef(i.jobj);
+            i.obj->deref(&xsink);
+        }
+        // exceptions raised by destructors of evicted wrappers cannot be reported to any caller
+        xsink.clear();
+    }
+};
+
+} // namespace jni
+
+#endif // QORE_JNI_JAVAIDENTITYCACHE_H_
@@ -0,0 +1,142 @@
+//--------------------------------------------------------------------*- C++ -*-
+//
+//  Qore Programming Language
+//
+//  Copyright (C) 2016 - 2021 Qore Technologies, s.r.o.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//------------------------------------------------------------------------------
+///
+/// \file
+/// \brief Defines the JavaKeyCache class.
+///
+//------------------------------------------------------------------------------
+#ifndef QORE_JNI_JAVAKEYCACHE_H_
+#define QORE_JNI_JAVAKEYCACHE_H_
+
+#include <qore/Qore.h>
+#include <jni.h>
+
+#include <atomic>
+#include <string>
+#include <unordered_map>
+
+#include "Env.h"
+#include "GlobalReference.h"
+#include "StringTranscoder.h"
+
+namespace jni {
+
+/**
+ * \brief A bounded intern table of Java strings for hash keys.
+ *
+ * Hashes converted to Java maps usually repeat the same keys; the cache holds a global reference to one Java string
+ * per key so that repeated keys are passed to Java without creating a new string each time.  Entries are never
+ * evicted; once the cache is full, new keys are not cached.
+ */
+class JavaKeyCache {
+public:
+    //! keys longer than this are never cached
+    static constexpr size_t MaxKeyLen = 256;
+
+    /**
+     * \brief Creates the cache.
+     * \param max_size the maximum number of cached keys
+     */
+    DLLLOCAL JavaKeyCache(size_t max_size) : max_size(max_size) {
+    }
+
+    /**
+     * \brief Returns the interned Java string for the given key, adding it to the cache if possible.
+     * \param env the JNI environment
+     * \param key the key in UTF-8 encoding
+     * \return a global reference owned by the cache that remains valid until clear() is called, or nullptr if the
+     * key is not cached and cannot be added; in this case the caller must create the string itself
+     * \throws JavaException if the string cannot be created
+     */
+    DLLLOCAL jstring get(Env& env, const char* key) {
+        size_t len = strlen(key);
+        if (len > MaxKeyLen) {
+            ++misses;
+            return nullptr;
+        }
+        std::string str(key, len);
+        {
+            QoreAutoRWReadLocker al(lck);
+            map_t::const_iterator i = map.find(str);
+            if (i != map.end()) {
+                ++hits;
+                return i->second;
+            }
+        }
+        ++misses;
+
+        QoreAutoRWWriteLocker al(lck);
+        // check again in case another thread added the key in the meantime
+        map_t::const_iterator i = map.find(str);
+        if (i != map.end()) {
+            return i->second;
+        }
+        if (map.size() >= max_size) {
+            return nullptr;
+        }
+        GlobalReference<jstring> jstr = StringTranscoder::toJava(env, key, len).makeGlobal();
+        return map.emplace(std::move(str), std::move(jstr)).first->second;
+    }
+
+    /**
+     * \brief Removes all entries from the cache; strings returned by get() are no longer valid after this call.
+     */
+    DLLLOCAL void clear() {
+        QoreAutoRWWriteLocker al(lck);
+        map.clear();
+    }
+
+    /**
+     * \brief Returns cache statistics.
+     * \return a hash with the following keys: \c max_size, \c size, \c hits, \c misses
+     */
+    DLLLOCAL QoreHashNode* getStats() {
+        ReferenceHolder<QoreHashNode> rv(new QoreHashNode(autoTypeInfo), nullptr);
+        size_t size;
+        {
+            QoreAutoRWReadLocker al(lck);
+            size = map.size();
+        }
+        rv->setKeyValue("max_size", (int64)max_size, nullptr);
+        rv->setKeyValue("size", (int64)size, nullptr);
+        rv->setKeyValue("hits", (int64)hits.load(), nullptr);
+        rv->setKeyValue("misses", (int64)misses.load(), nullptr);
+        return rv.release();
+    }
+
+private:
+    typedef std::unordered_map<std::string, GlobalReference<jstring>> map_t;
+
+    QoreRWLock lck;
+    size_t max_size;
+    map_t map;
+    std::atomic<uint64_t> hits = {0};
+    std::atomic<uint64_t> misses = {0};
+};
+
+} // namespace jni
+
+#endif // QORE_JNI_JAVAKEYCACHE_H_
@@ -26,155 +26,384 @@
 
 #include <qore/Qore.h>
 
+#include <unordered_map>
+
 #include "QoreJniClassMap.h"
 #include "Globals.h"
 #include "JavaToQore.h"
+#include "QoreToJava.h"
 #include "QoreJniFunctionalInterface.h"
+#include "StringTranscoder.h"
+#include "NumberConverter.h"
+#include "CollectionView.h"
 
 namespace jni {
 
-QoreValue JavaToQore::convertToQore(LocalReference<jobject> v, QoreProgram* pgm, bool compat_types) {
-    if (!v) {
-        return QoreValue();
-    }
-
-    Env env;
+namespace {
+//! cached conversion kinds for a runtime class
+struct ValueKindEntry {
+    //! weak reference to the class, so that cached classes can still be unloaded
+    jweak cls;
+    //! the conversion kind when maps are converted to hashes
+    JavaValueKind kind;
+    //! the conversion kind when maps are not converted to hashes
+    JavaValueKind nomap_kind;
+};
+
+// maps class identity hash codes to cache entries
+typedef std::unordered_multimap<jint, ValueKindEntry> vkmap_t;
+
+// the maximum number of cached classes before entries for unloaded classes are purged
+static constexpr size_t ValueKindCacheMax = 4096;
+
+static QoreRWLock vk_lock;
+static vkmap_t vk_map;
+}
 
-    // convert to Qore value if possible
-    if (env.isInstanceOf(v, Globals::classString)) {
-        Env::GetStringUtfChars chars(env, v.as<jstring>());
-        return QoreValue(new QoreStringNode(chars.c_str(), QCS_UTF8));
+JavaValueKind JavaToQore::classify(Env& env, jclass jc, bool maps) {
+    // the order of the checks determines the conversion for classes that match more than one type
+    if (env.isAssignableFrom(jc, Globals::classString)) {
+        return JavaValueKind::String;
+    }
+    if (env.isAssignableFrom(jc, Globals::classZonedDateTime)) {
+        return JavaValueKind::ZonedDateTime;
+    }
+    if (env.isAssignableFrom(jc, Globals::classBigDecimal)) {
+        return JavaValueKind::BigDecimal;
+    }
+    if (env.isAssignableFrom(jc, Globals::classQoreObjectBase)) {
+        return JavaValueKind::QoreObjectBase;
+    }
+    if (env.isAssignableFrom(jc, Globals::classQoreClosure)) {
+        return JavaValueKind::QoreClosure;
+    }
+    if (maps && env.isAssignableFrom(jc, Globals::classQoreHashProxy)) {
+        return JavaValueKind::QoreHashProxy;
+    }
+    if (maps && env.isAssignableFrom(jc, Globals::classMap)) {
+        return JavaValueKind::Map;
+    }
+    if (env.isAssignableFrom(jc, Globals::classList)) {
+        return JavaValueKind::List;
+    }
+    if (env.isAssignableFrom(jc, Globals::classQoreRelativeTime)) {
+        return JavaValueKind::QoreRelativeTime;
+    }
+    if (env.isAssignableFrom(jc, Globals::classQoreClosureMarker)) {
+        return JavaValueKind::QoreClosureMarker;
+    }
+    if (env.callBooleanMethod(jc, Globals::methodClassIsArray, nullptr)) {
+        return JavaValueKind::Array;
+    }
+    if (env.isSameObject(jc, Globals::classInteger)) {
+        return JavaValueKind::Integer;
+    }
+    if (env.isSameObject(jc, Globals::classLong)) {
+        return JavaValueKind::Long;
+    }
+    if (env.isSameObject(jc, Globals::classShort)) {
+        return JavaValueKind::Short;
     }
+    if (env.isSameObject(jc, Globals::classByte)) {
+        return JavaValueKind::Byte;
+    }
+    if (env.isSameObject(jc, Globals::classBoolean)) {
+        return JavaValueKind::Boolean;
+    }
+    if (env.isSameObject(jc, Globals::classDouble)) {
+        return JavaValueKind::Double;
+    }
+    if (env.isSameObject(jc, Globals::classFloat)) {
+        return JavaValueKind::Float;
+    }
+    if (env.isSameObject(jc, Globals::classCharacter)) {
+        return JavaValueKind::Character;
+    }
+    if (jni_byte_buffers && env.isAssignableFrom(jc, Globals::classByteBuffer)) {
+        return JavaValueKind::ByteBuffer;
+    }
+    return JavaValueKind::Object;
+}
 
-    if (env.isInstanceOf(v, Globals::classZonedDateTime)) {
-        LocalReference<jstring> date_str = env.callObjectMethod(v,
-            Globals::methodZonedDateTimeToString, nullptr).as<jstring>();
-        Env::GetStringUtfChars chars(env, date_str);
-        return QoreValue(new DateTimeNode(chars.c_str()));
+JavaValueKind JavaToQore::getValueKind(Env& env, jclass jc, bool maps) {
+    jvalue jarg;
+    jarg.l = jc;
+    jint hash = env.callStaticIntMethod(Globals::classSystem, Globals::methodSystemIdentityHashCode, &jarg);
+
+    {
+        QoreAutoRWReadLocker al(vk_lock);
+        auto range = vk_map.equal_range(hash);
+        for (auto i = range.first; i != range.second; ++i) {
+            if (env.isSameObject(i->second.cls, jc)) {
+                return maps ? i->second.kind : i->second.nomap_kind;
+            }
+        }
     }
 
-    if (env.isInstanceOf(v, Globals::classBigDecimal)) {
-        LocalReference<jstring> num_str = env.callObjectMethod(v,
-            Globals::methodBigDecimalToString, nullptr).as<jstring>();
-        Env::GetStringUtfChars chars(env, num_str);
-        return QoreValue(new QoreNumberNode(chars.c_str()));
+    ValueKindEntry entry;
+    entry.kind = classify(env, jc, true);
+    entry.nomap_kind = (entry.kind == JavaValueKind::Map || entry.kind == JavaValueKind::QoreHashProxy)
+        ? classify(env, jc, false)
+        : entry.kind;
+
+    QoreAutoRWWriteLocker al(vk_lock);
+    // check again in case another thread added the class in the meantime
+    auto range = vk_map.equal_range(hash);
+    for (auto i = range.first; i != range.second; ++i) {
+        if (env.isSameObject(i->second.cls, jc)) {
+            return maps ? i->second.kind : i->second.nomap_kind;
+        }
     }
+    if (vk_map.size() >= ValueKindCacheMax) {
+        // purge entries for classes that have been unloaded
+        for (vkmap_t::iterator i = vk_map.begin(), e = vk_map.end(); i != e;) {
+            if (env.isSameObject(i->second.cls, nullptr)) {
+                env.deleteWeakGlobalRef(i->second.cls);
+                i = vk_map.erase(i);
+            } else {
+                ++i;
+            }
+        }
+    }
+    if (vk_map.size() < ValueKindCacheMax) {
+        entry.cls = env.newWeakGlobalRef(jc);
+        vk_map.insert(vkmap_t::value_type(hash, entry));
+    }
+    return maps ? entry.kind : entry.nomap_kind;
+}
 
-    if (env.isInstanceOf(v, Globals::classQoreObjectBase)) {
-        QoreObject* obj = reinterpret_cast<QoreObject*>(env.callLongMethod(v,
-            Globals::methodQoreObjectBaseGet, nullptr));
-        return obj->refSelf();
+void JavaToQore::clearValueKindCache() {
+    Env env;
+    QoreAutoRWWriteLocker al(vk_lock);
+    for (auto& i : vk_map) {
+        env.deleteWeakGlobalRef(i.second.cls);
     }
+    vk_map.clear();
+}
 
-    if (env.isInstanceOf(v, Globals::classQoreClosure)) {
-        ResolvedCallReferenceNode* call = reinterpret_cast<ResolvedCallReferenceNode*>(env.callLongMethod(v,
-            Globals::methodQoreClosureGet, nullptr));
-        return call->refRefSelf();
+QoreValue JavaToQore::convertToQore(LocalReference<jobject> v, QoreProgram* pgm, bool compat_types) {
+    if (!v) {
+        return QoreValue();
     }
 
-    if (env.isInstanceOf(v, Globals::classMap) && !JniExternalProgramData::compatTypes()) {
-        // create hash from Map
-        LocalReference<jobject> set = env.callObjectMethod(v,
-            Globals::methodMapEntrySet, nullptr);
-        if (!set) {
-            return QoreValue();
+    Env env;
+
+    // convert to Qore value if possible
+    LocalReference<jclass> jc = env.getObjectClass(v);
+    switch (getValueKind(env, jc, !JniExternalProgramData::compatTypes())) {
+        case JavaValueKind::String:
+            return QoreValue(StringTranscoder::toQore(env, v.cast<jstring>()));
+
+        case JavaValueKind::ZonedDateTime: {
+            int64 secs = env.callLongMethod(v, Globals::methodZonedDateTimeToEpochSecond, nullptr);
+            int nanos = env.callIntMethod(v, Globals::methodZonedDateTimeGetNano, nullptr);
+            LocalReference<jobject> offset = env.callObjectMethod(v, Globals::methodZonedDateTimeGetOffset,
+                nullptr);
+            int seconds_east = env.callIntMethod(offset, Globals::methodZoneOffsetGetTotalSeconds, nullptr);
+            return QoreValue(DateTimeNode::makeAbsolute(findCreateOffsetZone(seconds_east), secs, nanos / 1000));
         }
-        LocalReference<jobject> i = env.callObjectMethod(set,
-            Globals::methodSetIterator, nullptr);
-        if (!i) {
-            return QoreValue();
+
+        case JavaValueKind::BigDecimal:
+            return QoreValue(NumberConverter::toQore(env, v));
+
+        case JavaValueKind::QoreObjectBase: {
+            QoreObject* obj = reinterpret_cast<QoreObject*>(env.callLongMethod(v,
+                Globals::methodQoreObjectBaseGet, nullptr));
+            return obj->refSelf();
         }
 
-        ExceptionSink xsink;
-        ReferenceHolder<QoreHashNode> rv(new QoreHashNode(autoTypeInfo), &xsink);
-        while (true) {
-            if (!env.callBooleanMethod(i, Globals::methodIteratorHasNext, nullptr)) {
-                break;
+        case JavaValueKind::QoreClosure: {
+            ResolvedCallReferenceNode* call = reinterpret_cast<ResolvedCallReferenceNode*>(env.callLongMethod(v,
+                Globals::methodQoreClosureGet, nullptr));
+            return call->refRefSelf();
+        }
+
+        case JavaValueKind::QoreHashProxy: {
+            // a proxy that has not been modified and whose retrieved values cannot have been modified is converted
+            // back to the original hash
+            QoreHashNode* h = reinterpret_cast<QoreHashNode*>(env.callLongMethod(v,
+                Globals::methodQoreHashProxyGetHashPtr, nullptr));
+            if (h) {
+                h->ref();
+                return h;
             }
+            return convertMap(env, v, jc, pgm, compat_types);
+        }
 
-            LocalReference<jobject> element = env.callObjectMethod(i,
-                Globals::methodIteratorNext, nullptr);
-            if (element) {
-                LocalReference<jobject> key = env.callObjectMethod(element,
-                    Globals::methodEntryGetKey, nullptr);
-
-                // if key is not a string, then we cannot convert it to Qore
-                if (!env.isInstanceOf(key, Globals::classString)) {
-                    return qjcm.getValue(v, pgm, compat_types);
-                }
-
-                LocalReference<jobject> value = env.callObjectMethod(element,
-                    Globals::methodEntryGetValue, nullptr);
-
-                ValueHolder val(convertToQore(value.release(), pgm, compat_types), &xsink);
-                if (xsink) {
-                    break;
-                }
-
-                Env::GetStringUtfChars key_str(env, key.as<jstring>());
-                rv->setKeyValue(key_str.c_str(), val.release(), &xsink);
-                if (xsink) {
-                    break;
-                }
+        case JavaValueKind::Map:
+            if (JniExternalProgramData::lazyCollections()) {
+                return new QoreObject(QC_JAVAMAPVIEW, pgm, new MapView(v));
             }
+            return convertMap(env, v, jc, pgm, compat_types);
+
+        case JavaValueKind::List:
+            if (JniExternalProgramData::lazyCollections()) {
+                return new QoreObject(QC_JAVALISTVIEW, pgm, new ListView(v));
+            }
+            return convertList(env, v, pgm, compat_types);
+
+        // for relative date/time values
+        case JavaValueKind::QoreRelativeTime: {
+            int year = env.getIntField(v, Globals::fieldQoreRelativeTimeYear),
+                month = env.getIntField(v, Globals::fieldQoreRelativeTimeMonth),
+                day = env.getIntField(v, Globals::fieldQoreRelativeTimeDay),
+                hour = env.getIntField(v, Globals::fieldQoreRelativeTimeHour),
+                minute = env.getIntField(v, Globals::fieldQoreRelativeTimeMinute),
+                second = env.getIntField(v, Globals::fieldQoreRelativeTimeSecond),
+                us = env.getIntField(v, Globals::fieldQoreRelativeTimeUs);
+
+            return QoreValue(DateTimeNode::makeRelative(year, month, day, hour, minute, second, us));
+        }
+
+        // for Qore closure / call references
+        case JavaValueKind::QoreClosureMarker:
+            return new QoreJniFunctionalInterface(v);
+
+        case JavaValueKind::Array: {
+            ReferenceHolder<> return_value(nullptr);
+            Array::getList(return_value, env, v.cast<jarray>(), jc, pgm, compat_types);
+            return return_value.release();
         }
 
-        if (xsink) {
-            throw XsinkException(xsink);
+        case JavaValueKind::Integer:
+            return env.callIntMethod(v, Globals::methodIntegerIntValue, nullptr);
+
+        case JavaValueKind::Long:
+            return env.callLongMethod(v, Globals::methodLongLongValue, nullptr);
+
+        case JavaValueKind::Short:
+            return env.callShortMethod(v, Globals::methodShortShortValue, nullptr);
+
+        case JavaValueKind::Byte:
+            return env.callByteMethod(v, Globals::methodByteByteValue, nullptr);
+
+        case JavaValueKind::Boolean:
+            return (bool)env.callBooleanMethod(v, Globals::methodBooleanBooleanValue, nullptr);
+
+        case JavaValueKind::Double:
+            return (double)env.callDoubleMethod(v, Globals::methodDoubleDoubleValue, nullptr);
+
+        case JavaValueKind::Float:
+            return (double)env.callFloatMethod(v, Globals::methodFloatFloatValue, nullptr);
+
+        case JavaValueKind::Character:
+            return (int64)env.callCharMethod(v, Globals::methodCharacterCharValue, nullptr);
+
+        case JavaValueKind::ByteBuffer: {
+            // heap buffers are returned as Java objects
+            BinaryNode* b = toBinary(env, v);
+            if (b) {
+                return b;
+            }
+            break;
         }
 
-        return rv.release();
+        case JavaValueKind::Object:
+        default:
+            break;
     }
 
-    if (env.isInstanceOf(v, Globals::classList)) {
-        // create list from List
-        jint size = env.callIntMethod(v, Globals::methodListSize, nullptr);
+    return qjcm.getValue(env, v, jc, pgm);
+}
 
-        ExceptionSink xsink;
-        ReferenceHolder<QoreListNode> rv(new QoreListNode(autoTypeInfo), &xsink);
+BinaryNode* JavaToQore::toBinary(Env& env, jobject buf) {
+    void* ptr = env.getDirectBufferAddress(buf);
+    if (!ptr) {
+        return nullptr;
+    }
+    jlong size = env.getDirectBufferCapacity(buf);
+    if (size <= 0) {
+        return new BinaryNode;
+    }
 
-        jint pos = 0;
-        while (pos < size) {
-            std::vector<jvalue> jargs(1);
-            jargs[0].i = pos++;
+    // buffers created for Qore binary values refer to the original value
+    BinaryNode* b = QoreToJava::findDirectBinary(ptr, size);
+    if (b) {
+        return b;
+    }
 
-            LocalReference<jobject> value = env.callObjectMethod(v,
-                Globals::methodListGet, &jargs[0]);
+    // BinaryNode cannot refer to foreign memory, so other buffers are copied
+    void* data = malloc(size);
+    if (!data) {
+        QoreStringMaker desc("cannot allocate " QLLD " bytes for the contents of a direct ByteBuffer", (int64)size);
+        throw BasicException(desc.c_str());
+    }
+    memcpy(data, ptr, size);
+    return new BinaryNode(data, size);
+}
 
-            ValueHolder val(convertToQore(value.release(), pgm, compat_types), &xsink);
+QoreValue JavaToQore::convertMap(Env& env, LocalReference<jobject>& v, LocalReference<jclass>& jc, QoreProgram* pgm,
+        bool compat_types) {
+    // create hash from Map; the entries are retrieved with a single call as interleaved keys and values
+    jvalue jarg;
+    jarg.l = v;
+    LocalReference<jobjectArray> entries = env.callStaticObjectMethod(Globals::classQoreJavaApi,
+        Globals::methodQoreJavaApiFlattenMap, &jarg).as<jobjectArray>();
+    // if any key is null or not a string, then we cannot convert it to Qore
+    if (!entries) {
+        return qjcm.getValue(env, v, jc, pgm);
+    }
+    jsize size = env.getArrayLength(entries);
+
+    ExceptionSink xsink;
+    ReferenceHolder<QoreHashNode> rv(new QoreHashNode(autoTypeInfo), &xsink);
+    {
+        // local references for each entry are freed in bulk when the frame is recycled
+        Env::LocalFrame frame(env);
+        for (jsize i = 0; i < size; i += 2) {
+            frame.next();
+            LocalReference<jstring> key = env.getObjectArrayElement(entries, i).as<jstring>();
+
+            ValueHolder val(convertToQore(env.getObjectArrayElement(entries, i + 1), pgm, compat_types),
+                &xsink);
             if (xsink) {
                 break;
             }
 
-            rv->push(val.release(), &xsink);
-        }
-
-        if (xsink) {
-            throw XsinkException(xsink);
+            SimpleRefHolder<QoreStringNode> key_str(StringTranscoder::toQore(env, key));
+            rv->setKeyValue(key_str->c_str(), val.release(), &xsink);
+            if (xsink) {
+                break;
+            }
         }
+    }
 
-        return rv.release();
+    if (xsink) {
+        throw XsinkException(xsink);
     }
 
-    // for relative date/time values
-    if (env.isInstanceOf(v, Globals::classQoreRelativeTime)) {
-        int year = env.getIntField(v, Globals::fieldQoreRelativeTimeYear),
-            month = env.getIntField(v, Globals::fieldQoreRelativeTimeMonth),
-            day = env.getIntField(v, Globals::fieldQoreRelativeTimeDay),
-            hour = env.getIntField(v, Globals::fieldQoreRelativeTimeHour),
-            minute = env.getIntField(v, Globals::fieldQoreRelativeTimeMinute),
-            second = env.getIntField(v, Globals::fieldQoreRelativeTimeSecond),
-            us = env.getIntField(v, Globals::fieldQoreRelativeTimeUs);
+    return rv.release();
+}
+
+QoreValue JavaToQore::convertList(Env& env, LocalReference<jobject>& v, QoreProgram* pgm, bool compat_types) {
+    // create list from List; List.toArray() copies the elements in one call and avoids the O(n^2) cost of
+    // List.get() on lists without random access
+    LocalReference<jobjectArray> elements = env.callObjectMethod(v, Globals::methodListToArray,
+        nullptr).as<jobjectArray>();
+    jsize size = elements ? env.getArrayLength(elements) : 0;
+
+    ExceptionSink xsink;
+    ReferenceHolder<QoreListNode> rv(new QoreListNode(autoTypeInfo), &xsink);
+    {
+        // local references for each element are freed in bulk when the frame is recycled
+        Env::LocalFrame frame(env);
+        for (jsize i = 0; i < size; ++i) {
+            frame.next();
+            ValueHolder val(convertToQore(env.getObjectArrayElement(elements, i), pgm, compat_types),
+                &xsink);
+            if (xsink) {
+                break;
+            }
 
-        return QoreValue(DateTimeNode::makeRelative(year, month, day, hour, minute, second, us));
+            rv->push(val.release(), &xsink);
+        }
     }
 
-    // for Qore closure / call references
-    if (env.isInstanceOf(v, Globals::classQoreClosureMarker)) {
-        return new QoreJniFunctionalInterface(v);
+    if (xsink) {
+        throw XsinkException(xsink);
     }
 
-    return qjcm.getValue(v, pgm, compat_types);
+    return rv.release();
 }
 
 } // namespace jni
@@ -44,6 +44,31 @@
 
 namespace jni {
 
+//! The conversion applied to Java objects of a given runtime class
+enum class JavaValueKind : unsigned char {
+   Object,              //!< wrapped in a Qore object of the corresponding Qore class
+   Array,               //!< converted to a list or binary value
+   String,              //!< java.lang.String
+   ZonedDateTime,       //!< java.time.ZonedDateTime
+   BigDecimal,          //!< java.math.BigDecimal
+   QoreObjectBase,      //!< org.qore.jni.QoreObjectBase
+   QoreClosure,         //!< org.qore.jni.QoreClosure
+   QoreHashProxy,       //!< org.qore.jni.QoreHashProxy
+   Map,                 //!< java.util.Map
+   List,                //!< java.util.List
+   QoreRelativeTime,    //!< org.qore.jni.QoreRelativeTime
+   QoreClosureMarker,   //!< org.qore.jni.QoreClosureMarker
+   Integer,             //!< java.lang.Integer
+   Long,                //!< java.lang.Long
+   Short,               //!< java.lang.Short
+   Byte,                //!< java.lang.Byte
+   Boolean,             //!< java.lang.Boolean
+   Double,              //!< java.lang.Double
+   Float,               //!< java.lang.Float
+   Character,           //!< java.lang.Character
+   ByteBuffer,          //!< java.nio.ByteBuffer; only if the \c byte-buffers module option is set
+};
+
 /**
  * \brief Provides functions for converting Java values to Qore.
  *
@@ -87,8 +112,42 @@ public:
 
    static QoreValue convertToQore(LocalReference<jobject> v, QoreProgram* pgm, bool compat_types);
 
+   /**
+    * \brief Returns the conversion kind for objects of the given runtime class.
+    *
+    * The result is cached per class with a weak global reference, so after the first lookup for a class only an
+    * identity hash and an identity comparison are needed.
+    * \param env the JNI environment
+    * \param jc the runtime class of the object
+    * \param maps if false, then \c java.util.Map objects are not converted to hashes
+    * \return the conversion kind
+    */
+   static JavaValueKind getValueKind(Env& env, jclass jc, bool maps);
+
+   //! Frees all cached conversion kinds; called before the JVM is destroyed
+   static void clearValueKindCache();
+
+   /**
+    * \brief Converts the contents of a direct java.nio.ByteBuffer to a binary value.
+    *
+    * Buffers created for Qore binary values return the original value without copying; for other direct buffers,
+    * the memory is copied once.
+    * \param env the JNI environment
+    * \param buf the buffer
+    * \return the binary value or nullptr if \a buf is not a direct buffer
+    */
+   static BinaryNode* toBinary(Env& env, jobject buf);
+
 private:
    JavaToQore() = delete;
+
+   //! Determines the conversion kind for the given class without the cache
+   static JavaValueKind classify(Env& env, jclass jc, bool maps);
+
+   static QoreValue convertMap(Env& env, LocalReference<jobject>& v, LocalReference<jclass>& jc, QoreProgram* pgm,
+         bool compat_types);
+
+   static QoreValue convertList(Env& env, LocalReference<jobject>& v, QoreProgram* pgm, bool compat_types);
 };
 
 } // namespace jni
@@ -43,6 +43,7 @@ void BaseMethod::init(Env &env) {
     varargs = env.callBooleanMethod(method, Globals::methodMethodIsVarArgs, nullptr);
 
     paramTypes.reserve(paramCount);
+    paramKinds.reserve(paramCount);
     for (jsize p = 0; p < paramCount; ++p) {
         LocalReference<jclass> paramType = env.getObjectArrayElement(paramTypesArray, p).as<jclass>();
         if (!varargs && (p == (paramCount - 1)) && env.callBooleanMethod(paramType, Globals::methodClassIsArray, nullptr)) {
@@ -52,7 +53,15 @@ void BaseMethod::init(Env &env) {
                 varargs = true;
             }
         }
-        paramTypes.emplace_back(Globals::getType(paramType), paramType.makeGlobal());
+        Type type = Globals::getType(paramType);
+        paramKinds.push_back(Globals::getTargetKind(paramType));
+        paramTypes.emplace_back(type, paramType.makeGlobal());
+    }
+
+    if (varargs && paramCount) {
+        varargsClass = env.callObjectMethod(paramTypes.back().second, Globals::methodClassGetComponentType,
+            nullptr).as<jclass>().makeGlobal();
+        varargsType = Globals::getType(varargsClass);
     }
 }
 
@@ -84,12 +93,7 @@ std::vector<jvalue> BaseMethod::convertArgs(const QoreListNode* args, size_t arg
         // process varargs with remaining arguments or with a single argument if appropriate
         if (varargs && (index == (paramCount - 1))
             && !(argCount == paramCount && args->retrieveEntry(index + arg_offset).getType() == NT_LIST)) {
-            // get array component type
-            Env env;
-            LocalReference<jclass> ccls = env.callObjectMethod(paramTypes[index].second,
-                Globals::methodClassGetComponentType, nullptr).as<jclass>();
-
-            jargs[index].l = Array::toObjectArray(args, ccls, index + arg_offset, jpc).release();
+            jargs[index].l = Array::toObjectArray(args, varargsClass, varargsType, index + arg_offset, jpc).release();
             break;
         }
         assert(!args || args->empty() || (index < argCount));
@@ -123,7 +127,7 @@ std::vector<jvalue> BaseMethod::convertArgs(const QoreListNode* args, size_t arg
             case Type::Reference:
             default:
                 assert(paramTypes[index].first == Type::Reference);
-                jargs[index].l = QoreToJava::toObject(qv, paramTypes[index].second, jpc);
+                jargs[index].l = QoreToJava::toObject(qv, paramTypes[index].second, paramKinds[index], jpc);
                 break;
         }
     }
@@ -164,19 +168,14 @@ LocalReference<jobjectArray> BaseMethod::convertArgsToArray(const QoreListNode*
         // process varargs with remaining arguments or with a single argument if appropriate
         if (varargs && (index == (paramCount - 1))
             && !(argCount == paramCount && args->retrieveEntry(index + arg_offset).getType() == NT_LIST)) {
-            // get array component type
-            Env env;
-            LocalReference<jclass> ccls = env.callObjectMethod(paramTypes[index].second,
-                Globals::methodClassGetComponentType, nullptr).as<jclass>();
-
             env.setObjectArrayElement(jargs, index + array_offset,
-                Array::toObjectArray(args, ccls, index + arg_offset, jpc).release());
+                Array::toObjectArray(args, varargsClass, varargsType, index + arg_offset, jpc).release());
             break;
         }
         assert(!args || args->empty() || (index < argCount));
         QoreValue qv = args ? args->retrieveEntry(index + arg_offset) : QoreValue();
         env.setObjectArrayElement(jargs, index + array_offset, QoreToJava::toObject(qv, paramTypes[index].second,
-            jpc));
+            paramKinds[index], jpc));
     }
 
     return jargs;
@@ -199,56 +198,148 @@ void BaseMethod::doObjectException(Env& env, jobject object) const {
     throw BasicException(desc.c_str());
 }
 
+bool BaseMethod::canCallDirect(Env& env, JniExternalProgramData* jpc) const {
+    int plan = invokePlan.load();
+    if (plan == PlanUnknown) {
+        // caller-sensitive methods must be called from Java code with the program's context
+        jvalue jarg;
+        jarg.l = method;
+        plan = env.callStaticBooleanMethod(jpc->getDynamicApi(), jpc->getIsCallerSensitiveId(), &jarg)
+            ? PlanDynamicApi
+            : PlanDirect;
+        invokePlan.store(plan);
+    }
+    return plan == PlanDirect;
+}
+
+QoreValue BaseMethod::invokeDirect(Env& env, jobject object, bool nonvirtual, const QoreListNode* args, int offset,
+        QoreProgram* pgm, JniExternalProgramData* jpc) const {
+    std::vector<jvalue> jargs = convertArgs(args, offset, jpc);
+    jclass jcls = cls->getJavaObject();
+    if (!object) {
+        switch (retValType) {
+            case Type::Boolean:
+                return JavaToQore::convert(env.callStaticBooleanMethod(jcls, id, &jargs[0]));
+            case Type::Byte:
+                return JavaToQore::convert(env.callStaticByteMethod(jcls, id, &jargs[0]));
+            case Type::Char:
+                return JavaToQore::convert(env.callStaticCharMethod(jcls, id, &jargs[0]));
+            case Type::Short:
+                return JavaToQore::convert(env.callStaticShortMethod(jcls, id, &jargs[0]));
+            case Type::Int:
+                return JavaToQore::convert(env.callStaticIntMethod(jcls, id, &jargs[0]));
+            case Type::Long:
+                return JavaToQore::convert(env.callStaticLongMethod(jcls, id, &jargs[0]));
+            case Type::Float:
+                return JavaToQore::convert(env.callStaticFloatMethod(jcls, id, &jargs[0]));
+            case Type::Double:
+                return JavaToQore::convert(env.callStaticDoubleMethod(jcls, id, &jargs[0]));
+            case Type::Reference:
+                return JavaToQore::convertToQore(env.callStaticObjectMethod(jcls, id, &jargs[0]), pgm,
+                    jpc->getCompatTypes());
+            case Type::Void:
+            default:
+                assert(retValType == Type::Void);
+                env.callStaticVoidMethod(jcls, id, &jargs[0]);
+                return QoreValue();
+        }
+    }
+
+    if (nonvirtual) {
+        switch (retValType) {
+            case Type::Boolean:
+                return JavaToQore::convert(env.callNonvirtualBooleanMethod(object, jcls, id, &jargs[0]));
+            case Type::Byte:
+                return JavaToQore::convert(env.callNonvirtualByteMethod(object, jcls, id, &jargs[0]));
+            case Type::Char:
+                return JavaToQore::convert(env.callNonvirtualCharMethod(object, jcls, id, &jargs[0]));
+            case Type::Short:
+                return JavaToQore::convert(env.callNonvirtualShortMethod(object, jcls, id, &jargs[0]));
+            case Type::Int:
+                return JavaToQore::convert(env.callNonvirtualIntMethod(object, jcls, id, &jargs[0]));
+            case Type::Long:
+                return JavaToQore::convert(env.callNonvirtualLongMethod(object, jcls, id, &jargs[0]));
+            case Type::Float:
+                return JavaToQore::convert(env.callNonvirtualFloatMethod(object, jcls, id, &jargs[0]));
+            case Type::Double:
+                return JavaToQore::convert(env.callNonvirtualDoubleMethod(object, jcls, id, &jargs[0]));
+            case Type::Reference:
+                return JavaToQore::convertToQore(env.callNonvirtualObjectMethod(object, jcls, id, &jargs[0]), pgm,
+                    jpc->getCompatTypes());
+            case Type::Void:
+            default:
+                assert(retValType == Type::Void);
+                env.callNonvirtualVoidMethod(object, jcls, id, &jargs[0]);
+                return QoreValue();
+        }
+    }
+
+    switch (retValType) {
+        case Type::Boolean:
+            return JavaToQore::convert(env.callBooleanMethod(object, id, &jargs[0]));
+        case Type::Byte:
+            return JavaToQore::convert(env.callByteMethod(object, id, &jargs[0]));
+        case Type::Char:
+            return JavaToQore::convert(env.callCharMethod(object, id, &jargs[0]));
+        case Type::Short:
+            return JavaToQore::convert(env.callShortMethod(object, id, &jargs[0]));
+        case Type::Int:
+            return JavaToQore::convert(env.callIntMethod(object, id, &jargs[0]));
+        case Type::Long:
+            return JavaToQore::convert(env.callLongMethod(object, id, &jargs[0]));
+        case Type::Float:
+            return JavaToQore::convert(env.callFloatMethod(object, id, &jargs[0]));
+        case Type::Double:
+            return JavaToQore::convert(env.callDoubleMethod(object, id, &jargs[0]));
+        case Type::Reference: {
+            if (!pgm) {
+                pgm = jni_get_program_context();
+                if (!pgm) {
+                    pgm = Globals::getJavaContextProgram();
+                }
+            }
+            return JavaToQore::convertToQore(env.callObjectMethod(object, id, &jargs[0]), pgm,
+                jpc ? jpc->getCompatTypes() : false);
+        }
+        case Type::Void:
+        default:
+            assert(retValType == Type::Void);
+            env.callVoidMethod(object, id, &jargs[0]);
+            return QoreValue();
+    }
+}
+
+jobject BaseMethod::getSpecialHandle(Env& env, JniExternalProgramData* jpc) const {
+    AutoLocker al(specialHandleLock);
+    if (!specialHandle) {
+        jvalue jarg;
+        jarg.l = method;
+        specialHandle = env.callStaticObjectMethod(jpc->getDynamicApi(), jpc->getSpecialHandleId(),
+            &jarg).makeGlobal();
+    }
+    return specialHandle;
+}
+
 QoreValue BaseMethod::invoke(jobject object, const QoreListNode* args, QoreProgram* pgm, int offset) const {
     Env env;
     if (!env.isInstanceOf(object, cls->getJavaObject())) {
         doObjectException(env, object);
     }
 
-    // try to make a call through the dynamic API
     JniExternalProgramData* jpc = pgm ? static_cast<JniExternalProgramData*>(pgm->getExternalData("jni")) : nullptr;
 
-    if (!jpc) {
-        // make a standard Java call; there will be no Java context for security access though
+    // make a direct call unless the method is caller-sensitive; in case there is no program context, there will be
+    // no Java context for security access
+    if (!jpc || canCallDirect(env, jpc)) {
         try {
-            std::vector<jvalue> jargs = convertArgs(args, offset, jpc);
-            switch (retValType) {
-                case Type::Boolean:
-                    return JavaToQore::convert(env.callBooleanMethod(object, id, &jargs[0]));
-                case Type::Byte:
-                    return JavaToQore::convert(env.callByteMethod(object, id, &jargs[0]));
-                case Type::Char:
-                    return JavaToQore::convert(env.callCharMethod(object, id, &jargs[0]));
-                case Type::Short:
-                    return JavaToQore::convert(env.callShortMethod(object, id, &jargs[0]));
-                case Type::Int:
-                    return JavaToQore::convert(env.callIntMethod(object, id, &jargs[0]));
-                case Type::Long:
-                    return JavaToQore::convert(env.callLongMethod(object, id, &jargs[0]));
-                case Type::Float:
-                    return JavaToQore::convert(env.callFloatMethod(object, id, &jargs[0]));
-                case Type::Double:
-                    return JavaToQore::convert(env.callDoubleMethod(object, id, &jargs[0]));
-                case Type::Reference: {
-                    if (!pgm) {
-                        pgm = jni_get_program_context();
-                        if (!pgm) {
-                            pgm = Globals::getJavaContextProgram();
-                        }
-                    }
-                    return JavaToQore::convertToQore(env.callObjectMethod(object, id, &jargs[0]), pgm, false);
-                }
-                case Type::Void:
-                default:
-                    assert(retValType == Type::Void);
-                    env.callVoidMethod(object, id, &jargs[0]);
-                    return QoreValue();
-            }
+            return invokeDirect(env, object, false, args, offset, pgm, jpc);
         } catch (JavaException& e) {
             // workaround for https://bugs.openjdk.java.net/browse/JDK-8221530
             if (e.checkBug_8221530()) {
                 throw;
             }
+            // make all further calls through the dynamic API
+            invokePlan.store(PlanDynamicApi);
         }
     }
     assert(jpc);
@@ -256,7 +347,7 @@ QoreValue BaseMethod::invoke(jobject object, const QoreListNode* args, QoreProgr
     // add the object as the first argument
     LocalReference<jobjectArray> vargs = convertArgsToArray(args, offset, 0, jpc).release();
 
-    // public static Object invokeMethodNonvirtual(Method m, Object obj, Object... args);
+    // public static Object invokeMethod(Method m, Object obj, Object... args);
     std::vector<jvalue> jargs(3);
     jargs[0].l = method;
     jargs[1].l = object;
@@ -278,28 +369,55 @@ QoreValue BaseMethod::invokeNonvirtual(jobject object, const QoreListNode* args,
     JniExternalProgramData* jpc = jni_get_context_unconditional(pgm);
     assert(jpc);
 
-    // add the object as the first argument
+    // make a direct call unless the method is caller-sensitive
+    if (canCallDirect(env, jpc)) {
+        try {
+            return invokeDirect(env, object, true, args, offset, pgm, jpc);
+        } catch (JavaException& e) {
+            // workaround for https://bugs.openjdk.java.net/browse/JDK-8221530
+            if (e.checkBug_8221530()) {
+                throw;
+            }
+            // make all further calls through the dynamic API
+            invokePlan.store(PlanDynamicApi);
+        }
+    }
+
     LocalReference<jobjectArray> vargs = convertArgsToArray(args, offset, 0, jpc).release();
 
-    // public static Object invokeMethodNonvirtual(Method m, Object obj, Object... args);
+    // public static Object invokeSpecial(MethodHandle mh, Object obj, Object[] args);
     std::vector<jvalue> jargs(3);
-    jargs[0].l = method;
+    jargs[0].l = getSpecialHandle(env, jpc);
     jargs[1].l = object;
     // process method arguments
     jargs[2].l = vargs;
 
     //printd(5, "BaseMethod::invokeNonvirtual() args: %d\n", (int)(args ? args->size() : 0));
     return JavaToQore::convertToQore(env.callStaticObjectMethod(jpc->getDynamicApi(),
-        jpc->getInvokeMethodNonvirtualId(), &jargs[0]), pgm, jpc->getCompatTypes());
+        jpc->getInvokeSpecialId(), &jargs[0]), pgm, jpc->getCompatTypes());
 }
 
 QoreValue BaseMethod::invokeStatic(const QoreListNode* args, QoreProgram* pgm, int offset) const {
     Env env;
 
-    // make the call through the dynamic API
     JniExternalProgramData* jpc = jni_get_context_unconditional(pgm);
     assert(jpc);
 
+    // make a direct call unless the method is caller-sensitive
+    if (canCallDirect(env, jpc)) {
+        try {
+            return invokeDirect(env, nullptr, false, args, offset, pgm, jpc);
+        } catch (JavaException& e) {
+            // workaround for https://bugs.openjdk.java.net/browse/JDK-8221530
+            if (e.checkBug_8221530()) {
+                throw;
+            }
+            // make all further calls through the dynamic API
+            invokePlan.store(PlanDynamicApi);
+        }
+    }
+
+    // make the call through the dynamic API
     LocalReference<jarray> vargs = args ? convertArgsToArray(args, offset, 0, jpc).release() : nullptr;
     std::vector<jvalue> jargs(3);
     jargs[0].l = method;
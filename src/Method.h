@@ -38,6 +38,8 @@
 
 #include <classfile_constants.h>
 
+#include <atomic>
+
 namespace jni {
 
 class QoreJniClassMap;
@@ -203,16 +205,53 @@ protected:
 
     DLLLOCAL void init(Env &env);
 
+    //! returns true if the method can be called directly with JNI with a program context
+    /** the result is determined once with the given program's dynamic API and cached
+     */
+    DLLLOCAL bool canCallDirect(Env& env, JniExternalProgramData* jpc) const;
+
+    //! makes a direct JNI call with unboxed arguments
+    /** @param object the object to call the method on or nullptr for static methods
+        @param nonvirtual true to make a non-virtual call on \a object
+     */
+    DLLLOCAL QoreValue invokeDirect(Env& env, jobject object, bool nonvirtual, const QoreListNode* args, int offset,
+            QoreProgram* pgm, JniExternalProgramData* jpc) const;
+
+    //! returns the cached method handle for non-virtual calls through the dynamic API, creating it if necessary
+    DLLLOCAL jobject getSpecialHandle(Env& env, JniExternalProgramData* jpc) const;
+
+    //! invocation plans for calls with a program context
+    enum InvokePlan : int {
+        //! the plan has not yet been determined
+        PlanUnknown = 0,
+        //! the method can be called directly with JNI
+        PlanDirect = 1,
+        //! the method is caller-sensitive and must be called through the program's dynamic API
+        PlanDynamicApi = 2,
+    };
+
     Class* cls;
     jmethodID id;
     GlobalReference<jobject> method;             // the instance of java.lang.reflect.Method
     GlobalReference<jclass> retValClass;
     Type retValType;
     std::vector<std::pair<Type, GlobalReference<jclass>>> paramTypes;
+    // target class classification for each parameter; determined once so that argument conversions do not need to
+    // check the class identity for each call; primitive parameters are classified by their boxed types
+    std::vector<TargetKind> paramKinds;
+    // the component class and type of the varargs array parameter, if any
+    GlobalReference<jclass> varargsClass;
+    Type varargsType = Type::Void;
     // method modifiers
     int mods;
     // varargs flag
     bool varargs;
+    // invocation plan for calls with a program context; one of the InvokePlan values
+    mutable std::atomic<int> invokePlan{PlanUnknown};
+    // lock for specialHandle
+    mutable QoreThreadLock specialHandleLock;
+    // method handle for non-virtual calls through the dynamic API; created on demand
+    mutable GlobalReference<jobject> specialHandle;
 };
 
 class Method : public BaseMethod {
@@ -0,0 +1,308 @@
+//--------------------------------------------------------------------*- C++ -*-
+//
+//  Qore Programming Language
+//
+//  Copyright (C) 2016 - 2021 Qore Technologies, s.r.o.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#include "NumberConverter.h"
+#include "Globals.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+
+namespace jni {
+
+bool NumberConverter::parseDecimal(const char* str, bool& negative, std::string& digits, int64& scale) {
+    const char* p = str;
+    negative = false;
+    if (*p == '-' || *p == '+') {
+        negative = *p == '-';
+        ++p;
+    }
+
+    digits.clear();
+    int64 frac = 0;
+    bool have_digit = false;
+    bool have_point = false;
+    for (; *p; ++p) {
+        if (*p >= '0' && *p <= '9') {
+            have_digit = true;
+            if (!digits.empty() || *p != '0') {
+                digits += *p;
+            }
+            if (have_point) {
+                ++frac;
+            }
+        } else if (*p == '.' && !have_point) {
+            have_point = true;
+        } else {
+            break;
+        }
+    }
+    if (!have_digit) {
+        return false;
+    }
+
+    int64 exp = 0;
+    if (*p == 'e' || *p == 'E') {
+        ++p;
+        bool exp_negative = false;
+        if (*p == '-' || *p == '+') {
+            exp_negative = *p == '-';
+            ++p;
+        }
+        if (*p < '0' || *p > '9') {
+            return false;
+        }
+        for (; *p >= '0' && *p <= '9'; ++p) {
+            exp = exp * 10 + (*p - '0');
+            if (exp > INT_MAX) {
+                return false;
+            }
+        }
+        if (exp_negative) {
+            exp = -exp;
+        }
+    }
+    if (*p) {
+        return false;
+    }
+
+    if (digits.empty()) {
+        digits = "0";
+        negative = false;
+    }
+    scale = frac - exp;
+    // the scale of a BigDecimal is an int
+    return scale >= INT_MIN && scale <= INT_MAX;
+}
+
+void NumberConverter::formatDecimal(std::string& out, bool negative, const std::string& digits, int64 scale) {
+    out.clear();
+    if (negative) {
+        out += '-';
+    }
+
+    // use the same format as BigDecimal.toString()
+    int64 adjusted = static_cast<int64>(digits.size()) - 1 - scale;
+    if (scale >= 0 && adjusted >= -6) {
+        if (!scale) {
+            out += digits;
+        } else if (static_cast<size_t>(scale) < digits.size()) {
+            out.append(digits, 0, digits.size() - scale);
+            out += '.';
+            out.append(digits, digits.size() - scale, std::string::npos);
+        } else {
+            out += "0.";
+            out.append(scale - digits.size(), '0');
+            out += digits;
+        }
+        return;
+    }
+
+    out += digits[0];
+    if (digits.size() > 1) {
+        out += '.';
+        out.append(digits, 1, std::string::npos);
+    }
+    char buf[32];
+    snprintf(buf, sizeof(buf), "E%+lld", static_cast<long long>(adjusted));
+    out += buf;
+}
+
+std::vector<jbyte> NumberConverter::digitsToMagnitude(const std::string& digits) {
+    // little-endian base 2^32 limbs
+    std::vector<uint32_t> limbs;
+    size_t i = 0;
+    while (i < digits.size()) {
+        // add up to 9 digits at a time
+        size_t n = std::min(digits.size() - i, static_cast<size_t>(9));
+        uint32_t mul = 1;
+        uint32_t chunk = 0;
+        for (size_t j = 0; j < n; ++j) {
+            mul *= 10;
+            chunk = chunk * 10 + (digits[i + j] - '0');
+        }
+        i += n;
+
+        uint64_t carry = chunk;
+        for (auto& limb : limbs) {
+            uint64_t t = static_cast<uint64_t>(limb) * mul + carry;
+            limb = static_cast<uint32_t>(t);
+            carry = t >> 32;
+        }
+        if (carry) {
+            limbs.push_back(static_cast<uint32_t>(carry));
+        }
+    }
+
+    std::vector<jbyte> rv;
+    rv.reserve(limbs.size() * 4);
+    for (auto li = limbs.rbegin(), le = limbs.rend(); li != le; ++li) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            jbyte b = static_cast<jbyte>((*li >> shift) & 0xff);
+            // skip leading zero bytes
+            if (rv.empty() && !b) {
+                continue;
+            }
+            rv.push_back(b);
+        }
+    }
+    return rv;
+}
+
+void NumberConverter::twosComplementToDigits(const jbyte* bytes, size_t len, bool& negative, std::string& digits) {
+    negative = len && bytes[0] < 0;
+
+    // get the big-endian magnitude
+    std::vector<uint8_t> mag(reinterpret_cast<const uint8_t*>(bytes), reinterpret_cast<const uint8_t*>(bytes) + len);
+    if (negative) {
+        bool carry = true;
+        for (auto i = mag.rbegin(), e = mag.rend(); i != e; ++i) {
+            *i = ~*i;
+            if (carry) {
+                carry = !++*i;
+            }
+        }
+    }
+
+    // big-endian base 2^32 limbs
+    std::vector<uint32_t> limbs((mag.size() + 3) / 4);
+    for (size_t i = 0; i < mag.size(); ++i) {
+        size_t bit = (mag.size() - 1 - i) * 8;
+        limbs[limbs.size() - 1 - bit / 32] |= static_cast<uint32_t>(mag[i]) << (bit % 32);
+    }
+
+    // divide by 10^9 repeatedly to get groups of 9 digits from least to most significant
+    std::vector<uint32_t> groups;
+    size_t start = 0;
+    while (true) {
+        while (start < limbs.size() && !limbs[start]) {
+            ++start;
+        }
+        if (start == limbs.size()) {
+            break;
+        }
+        uint64_t rem = 0;
+        for (size_t i = start; i < limbs.size(); ++i) {
+            uint64_t t = (rem << 32) | limbs[i];
+            limbs[i] = static_cast<uint32_t>(t / 1000000000);
+            rem = t % 1000000000;
+        }
+        groups.push_back(static_cast<uint32_t>(rem));
+    }
+
+    digits.clear();
+    if (groups.empty()) {
+        digits = "0";
+        negative = false;
+        return;
+    }
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u", groups.back());
+    digits += buf;
+    for (auto i = groups.rbegin() + 1, e = groups.rend(); i != e; ++i) {
+        snprintf(buf, sizeof(buf), "%09u", *i);
+        digits += buf;
+    }
+}
+
+bool NumberConverter::digitsToLong(const std::string& digits, bool negative, int64& v) {
+    if (digits.size() > MaxLongDigits) {
+        return false;
+    }
+    int64 rv = 0;
+    for (char c : digits) {
+        rv = rv * 10 + (c - '0');
+    }
+    v = negative ? -rv : rv;
+    return true;
+}
+
+LocalReference<jobject> NumberConverter::toJava(Env& env, const QoreNumberNode& num) {
+    QoreString str;
+    num.toString(str);
+
+    bool negative;
+    std::string digits;
+    int64 scale;
+    if (!parseDecimal(str.c_str(), negative, digits, scale)) {
+        // let BigDecimal raise an exception for values that it cannot represent
+        LocalReference<jstring> num_str = env.newString(str.c_str());
+        jvalue jarg;
+        jarg.l = num_str;
+        return env.newObject(Globals::classBigDecimal, Globals::ctorBigDecimal, &jarg);
+    }
+
+    jvalue jargs[2];
+    int64 v;
+    if (digitsToLong(digits, negative, v)) {
+        jargs[0].j = v;
+        jargs[1].i = static_cast<jint>(scale);
+        return env.callStaticObjectMethod(Globals::classBigDecimal, Globals::methodBigDecimalValueOf, jargs);
+    }
+
+    std::vector<jbyte> mag = digitsToMagnitude(digits);
+    LocalReference<jbyteArray> array = env.newByteArray(mag.size());
+    env.setBytes(array, mag.data(), mag.size());
+
+    jargs[0].i = negative ? -1 : 1;
+    jargs[1].l = array;
+    LocalReference<jobject> unscaled = env.newObject(Globals::classBigInteger, Globals::ctorBigIntegerSignumMagnitude,
+        jargs);
+
+    jargs[0].l = unscaled;
+    jargs[1].i = static_cast<jint>(scale);
+    return env.newObject(Globals::classBigDecimal, Globals::ctorBigDecimalBigIntegerInt, jargs);
+}
+
+QoreNumberNode* NumberConverter::toQore(Env& env, jobject dec) {
+    jint scale = env.callIntMethod(dec, Globals::methodBigDecimalScale, nullptr);
+
+    jvalue jarg;
+    jarg.l = dec;
+    jlong v = env.callStaticLongMethod(Globals::classQoreJavaApi, Globals::methodQoreJavaApiGetUnscaledLong, &jarg);
+
+    bool negative;
+    std::string digits;
+    if (v != LLONG_MIN) {
+        negative = v < 0;
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%llu", negative ? -static_cast<unsigned long long>(v)
+            : static_cast<unsigned long long>(v));
+        digits = buf;
+    } else {
+        LocalReference<jbyteArray> array = env.callStaticObjectMethod(Globals::classQoreJavaApi,
+            Globals::methodQoreJavaApiGetUnscaledBytes, &jarg).as<jbyteArray>();
+        jsize len = env.getArrayLength(array);
+        std::vector<jbyte> bytes(len);
+        env.getBytes(array, bytes.data(), len);
+        twosComplementToDigits(bytes.data(), len, negative, digits);
+    }
+
+    std::string str;
+    formatDecimal(str, negative, digits, scale);
+    return new QoreNumberNode(str.c_str());
+}
+
+} // namespace jni
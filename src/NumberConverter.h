@@ -0,0 +1,108 @@
+//--------------------------------------------------------------------*- C++ -*-
+//
+//  Qore Programming Language
+//
+//  Copyright (C) 2016 - 2021 Qore Technologies, s.r.o.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//------------------------------------------------------------------------------
+///
+/// \file
+/// \brief Defines the NumberConverter class.
+///
+//------------------------------------------------------------------------------
+#ifndef QORE_JNI_NUMBERCONVERTER_H_
+#define QORE_JNI_NUMBERCONVERTER_H_
+
+#include <qore/Qore.h>
+#include <jni.h>
+
+#include <string>
+#include <vector>
+
+#include "LocalReference.h"
+#include "Env.h"
+
+namespace jni {
+
+/**
+ * \brief Converts arbitrary-precision numbers between Qore and java.math.BigDecimal.
+ *
+ * Values are passed to and from Java as an unscaled value and a scale; unscaled values that fit in a \c long are
+ * passed directly and larger values as a byte array magnitude, so no decimal strings are created in Java.
+ */
+class NumberConverter {
+public:
+    /**
+     * \brief Converts a Qore number to a java.math.BigDecimal.
+     * \param env the JNI environment
+     * \param num the number to convert
+     * \return the BigDecimal object
+     * \throws JavaException if the number cannot be converted, e.g. if it is not finite
+     */
+    DLLLOCAL static LocalReference<jobject> toJava(Env& env, const QoreNumberNode& num);
+
+    /**
+     * \brief Converts a java.math.BigDecimal to a Qore number.
+     * \param env the JNI environment
+     * \param dec the BigDecimal object
+     * \return the Qore number
+     * \throws JavaException if a Java method call fails
+     */
+    DLLLOCAL static QoreNumberNode* toQore(Env& env, jobject dec);
+
+    //! Parses a decimal string in the format created by QoreNumberNode::toString()
+    /** @param str the string to parse
+        @param negative set to true if the number is negative
+        @param digits set to the unscaled value without leading zeros; "0" if the value is zero
+        @param scale set to the number of digits after the decimal point; may be negative
+
+        @return true if the string could be parsed, false if not (ex: \c NaN or infinite values)
+    */
+    DLLLOCAL static bool parseDecimal(const char* str, bool& negative, std::string& digits, int64& scale);
+
+    //! Converts the decimal digits returned by parseDecimal() to a \c long if they fit
+    /** @param digits the unscaled value without leading zeros
+        @param negative true if the value is negative
+        @param v set to the value if the digits fit in a \c long
+
+        @return true if \a v was set, false if the value may not fit in a \c long
+    */
+    DLLLOCAL static bool digitsToLong(const std::string& digits, bool negative, int64& v);
+
+    //! Formats an unscaled value and scale as a decimal string
+    DLLLOCAL static void formatDecimal(std::string& out, bool negative, const std::string& digits, int64 scale);
+
+    //! Converts decimal digits to a big-endian unsigned magnitude
+    DLLLOCAL static std::vector<jbyte> digitsToMagnitude(const std::string& digits);
+
+    //! Converts a big-endian two's complement value to decimal digits
+    DLLLOCAL static void twosComplementToDigits(const jbyte* bytes, size_t len, bool& negative, std::string& digits);
+
+private:
+    //! the maximum number of digits that always fit in a \c long
+    static constexpr size_t MaxLongDigits = 18;
+
+    NumberConverter() = delete;
+};
+
+} // namespace jni
+
+#endif // QORE_JNI_NUMBERCONVERTER_H_
@@ -339,6 +339,8 @@ void QoreJniClassMap::initBackground(QoreProgram* pgm) {
 
         jni->addSystemClass(initQoreInvocationHandlerClass(*jni));
         jni->addSystemClass(initJavaArrayClass(*jni));
+        jni->addSystemClass(initJavaMapViewClass(*jni));
+        jni->addSystemClass(initJavaListViewClass(*jni));
 
         // add low-level API functions
         init_jni_functions(*jni);
@@ -418,46 +420,33 @@ jclass QoreJniClassMap::findLoadClass(const char* jpath, QoreProgram* pgm) {
     return static_cast<Class*>(qc->getManagedUserData())->toLocal();
 }
 
-QoreValue QoreJniClassMap::getValue(LocalReference<jobject>& obj, QoreProgram* pgm, bool compat_types) {
-    Env env;
-
-    // see if object is an array
-    LocalReference<jclass> jc = env.getObjectClass(obj);
-
-    if (env.callBooleanMethod(jc, Globals::methodClassIsArray, nullptr)) {
-        ReferenceHolder<> return_value(nullptr);
-        Array::getList(return_value, env, obj.cast<jarray>(), jc, pgm, compat_types);
-        return return_value.release();
-    }
-
-    if (env.isSameObject(jc, Globals::classInteger)) {
-        return env.callIntMethod(obj, Globals::methodIntegerIntValue, nullptr);
+QoreValue QoreJniClassMap::getValue(Env& env, LocalReference<jobject>& obj, LocalReference<jclass>& jc,
+        QoreProgram* pgm) {
+    assert(pgm);
+    JavaIdentityCache* cache = nullptr;
+    jint hash = 0;
+    if (jni_identity_cache_size) {
+        JniExternalProgramData* jpc = static_cast<JniExternalProgramData*>(pgm->getExternalData("jni"));
+        if (jpc && (cache = jpc->getIdentityCache())) {
+            // return the existing wrapper if the object has already been returned to Qore
+            hash = JavaIdentityCache::getHash(env, obj);
+            QoreObject* qobj = cache->get(env, obj, hash);
+            if (qobj) {
+                return qobj;
+            }
+        }
     }
 
-    if (env.isSameObject(jc, Globals::classLong))
-        return env.callLongMethod(obj, Globals::methodLongLongValue, nullptr);
-
-    if (env.isSameObject(jc, Globals::classShort))
-        return env.callShortMethod(obj, Globals::methodShortShortValue, nullptr);
-
-    if (env.isSameObject(jc, Globals::classByte))
-        return env.callByteMethod(obj, Globals::methodByteByteValue, nullptr);
-
-    if (env.isSameObject(jc, Globals::classBoolean)) {
-        return (bool)env.callBooleanMethod(obj, Globals::methodBooleanBooleanValue, nullptr);
+    QoreObject* qobj = new QoreObject(qjcm.findCreateQoreClass(env, jc, pgm), pgm, new QoreJniPrivateData(obj));
+    if (cache) {
+        try {
+            cache->add(env, obj, hash, qobj);
+        } catch (jni::Exception& e) {
+            // the object is returned uncached if it cannot be added to the cache
+            e.ignore();
+        }
     }
-
-    if (env.isSameObject(jc, Globals::classDouble))
-        return (double)env.callDoubleMethod(obj, Globals::methodDoubleDoubleValue, nullptr);
-
-    if (env.isSameObject(jc, Globals::classFloat))
-        return (double)env.callFloatMethod(obj, Globals::methodFloatFloatValue, nullptr);
-
-    if (env.isSameObject(jc, Globals::classCharacter))
-        return (int64)env.callCharMethod(obj, Globals::methodCharacterCharValue, nullptr);
-
-    assert(pgm);
-    return new QoreObject(qjcm.findCreateQoreClass(env, jc, pgm), pgm, new QoreJniPrivateData(obj));
+    return qobj;
 }
 
 static LocalReference<jstring> get_dot_name(Env& env, const char* name) {
@@ -521,7 +510,11 @@ JniQoreClass* QoreJniClassMap::findCreateQoreClass(Env& env, LocalReference<jcla
     LocalReference<jobject> cl = env.callObjectMethod(jc, Globals::methodClassGetClassLoader, nullptr);
     bool base = (!baseClassLoader && !cl) || (cl && baseClassLoader && env.isSameObject(baseClassLoader, cl));
     printd(5, "QoreJniClassMap::findCreateQoreClass() '%s' base: %d\n", jpath.c_str(), base);
-    return findCreateQoreClass(env, cname, jpath.c_str(), new Class(jc), base, pgm);
+    JniQoreClass* rv = findCreateQoreClass(env, cname, jpath.c_str(), new Class(jc), base, pgm);
+    if (jni_lazy_classes) {
+        ensurePopulated(*rv, pgm);
+    }
+    return rv;
 }
 
 JniQoreClass* QoreJniClassMap::findCreateQoreClassInProgram(QoreString& name, const char* jpath, Class* c, QoreProgram* pgm) {
@@ -606,6 +599,9 @@ JniQoreClass* QoreJniClassMap::findCreateQoreClass(Env& env, const char* name, Q
     JniQoreClass* rv = findInternal(jpath.c_str());
     if (rv) {
         //printd(LogLevel, "QoreJniClassMap::findCreateQoreClass() '%s': %p\n", name, rv);
+        if (jni_lazy_classes) {
+            ensurePopulated(*rv, pgm);
+        }
         return rv;
     }
     //printd(LogLevel, "QoreJniClassMap::findCreateQoreClass() '%s' not cached\n", name);
@@ -623,7 +619,11 @@ JniQoreClass* QoreJniClassMap::findCreateQoreClass(Env& env, const char* name, Q
 
     QoreString cname(name);
     // create the class in the correct namespace
-    return findCreateQoreClass(env, cname, jpath.c_str(), cls.release(), base, pgm);
+    rv = findCreateQoreClass(env, cname, jpath.c_str(), cls.release(), base, pgm);
+    if (jni_lazy_classes) {
+        ensurePopulated(*rv, pgm);
+    }
+    return rv;
 }
 
 JniQoreClass* QoreJniClassMap::findCreateQoreClassInBase(Env& env, QoreString& name, const char* jpath, Class* c,
@@ -781,8 +781,8 @@ JniQoreClass* QoreJniClassMap::createClassInNamespace(QoreNamespace* ns, QoreNam
 
     addSuperClasses(qc, jc, jpath, pgm, jpc);
 
-    // add methods after parents
-    if (init_done) {
+    // add methods after parents; with lazy population, classes are populated on demand in ensurePopulated()
+    if (init_done && !jni_lazy_classes) {
         populateQoreClass(*qc, jc, pgm);
     }
 
@@ -904,6 +904,12 @@ void QoreJniClassMap::addSuperClass(Env& env, JniQoreClass& qc, jni::Class* pare
 }
 
 void QoreJniClassMap::populateQoreClass(JniQoreClass& qc, jni::Class* jc, QoreProgram* pgm) {
+    if (jc->isPopulating()) {
+        return;
+    }
+    // mark as being populated first to avoid recursive population when the class references itself
+    jc->setPopulating();
+
     // do constructors
     doConstructors(qc, jc, pgm);
 
@@ -912,6 +918,51 @@ void QoreJniClassMap::populateQoreClass(JniQoreClass& qc, jni::Class* jc, QorePr
 
     // do fields
     doFields(qc, jc, pgm);
+
+    // other threads can use the class without the lock from now on
+    jc->setPopulated();
+}
+
+void QoreJniClassMap::ensurePopulated(JniQoreClass& qc, QoreProgram* pgm) {
+    // classes created before initialization is complete are populated in initBackground()
+    if (!init_done) {
+        return;
+    }
+
+    // check without the lock first, as this is called every time a Java object is wrapped in a Qore object
+    Class* jc = static_cast<Class*>(qc.getManagedUserData());
+    if (jc->isPopulated()) {
+        return;
+    }
+
+    AutoLocker al(m);
+    // check again with the lock held in case another thread has populated the class in the meantime; a class that is
+    // being populated by this thread is also skipped
+    if (jc->isPopulating()) {
+        return;
+    }
+
+    if (!pgm) {
+        jni_get_context(pgm);
+        if (!pgm) {
+            throw BasicException("no Java context to populate Qore class");
+        }
+    }
+
+    printd(LogLevel, "QoreJniClassMap::ensurePopulated() populating '%s'\n", qc.getName());
+
+    // populate Java parent classes first so that inherited methods and members are available
+    QoreParentClassIterator hierarchy_iterator(qc);
+    while (hierarchy_iterator.next()) {
+        JniQoreClass* jpqc = const_cast<JniQoreClass*>(
+            dynamic_cast<const JniQoreClass*>(&hierarchy_iterator.getParentClass())
+        );
+        if (jpqc) {
+            populateQoreClass(*jpqc, static_cast<Class*>(jpqc->getManagedUserData()), pgm);
+        }
+    }
+
+    populateQoreClass(qc, jc, pgm);
 }
 
 void QoreJniClassMap::doConstructors(JniQoreClass& qc, jni::Class* jc, QoreProgram* pgm) {
@@ -1220,6 +1271,268 @@ jclass JniExternalProgramData::findJavaClass(const QoreClass& qc) {
     return i == q2jmap.end() ? nullptr : (jclass)i->second;
 }
 
+// returns the key for the given class in the persistent bytecode cache
+static std::string get_byte_code_cache_key(Env& env, const QoreClass& qcls, jstring jname, jobject class_loader,
+        jclass parent) {
+    std::string rv = "jni-" PACKAGE_VERSION;
+    rv += '\0';
+    rv += get_class_hash(qcls);
+    // parent classes can change without changing the hash of the class itself
+    {
+        QoreParentClassIterator ci(qcls);
+        while (ci.next()) {
+            rv += '\0';
+            rv += get_class_hash(ci.getParentClass());
+        }
+    }
+    rv += '\0';
+    {
+        // use a new local reference, as Env::GetStringUtfChars releases the reference it is given
+        LocalReference<jstring> jname_ref = env.newLocalRef(jname);
+        Env::GetStringUtfChars jname_str(env, jname_ref);
+        rv += jname_str.c_str();
+    }
+    rv += '\0';
+    // add the classpath and the versions of parent Java classes
+    jvalue jargs[2];
+    jargs[0].l = class_loader;
+    jargs[1].l = parent;
+    LocalReference<jstring> jenv = env.callStaticObjectMethod(Globals::classJavaClassBuilder,
+        Globals::methodJavaClassBuilderGetByteCodeCacheEnvironment, &jargs[0]).as<jstring>();
+    Env::GetStringUtfChars env_str(env, jenv);
+    rv += env_str.c_str();
+    return rv;
+}
+
+// returns a relocation descriptor for the given method
+static std::string get_method_reloc_desc(const QoreClass& cls, const QoreMethod& m) {
+    std::string rv = "M|";
+    switch (m.getMethodType()) {
+        case MT_Constructor:
+            rv += 'c';
+            break;
+        case MT_Static:
+            rv += 's';
+            break;
+        default:
+            rv += 'n';
+            break;
+    }
+    rv += '|';
+    rv += cls.getNamespacePath();
+    rv += '|';
+    rv += m.getName();
+    return rv;
+}
+
+// returns a relocation descriptor for the given method variant
+static std::string get_variant_reloc_desc(const QoreClass& cls, const QoreMethod& m, const QoreExternalVariant& v) {
+    std::string rv = get_method_reloc_desc(cls, m);
+    rv[0] = 'V';
+
+    unsigned idx = 0;
+    QoreExternalFunctionIterator vi(*m.getFunction());
+    while (vi.next()) {
+        if (vi.getVariant() == &v) {
+            break;
+        }
+        ++idx;
+    }
+    rv += '|';
+    rv += std::to_string(idx);
+    return rv;
+}
+
+// returns the given class or the parent class with the given namespace path
+static const QoreClass* find_reloc_class(const QoreClass& qcls, const std::string& path) {
+    if (qcls.getNamespacePath() == path) {
+        return &qcls;
+    }
+    QoreParentClassIterator ci(qcls);
+    while (ci.next()) {
+        if (ci.getParentClass().getNamespacePath() == path) {
+            return &ci.getParentClass();
+        }
+    }
+    return nullptr;
+}
+
+// returns the method for a relocation descriptor
+static const QoreMethod* find_reloc_method(const QoreClass& cls, char type, const std::string& name) {
+    if (type == 's') {
+        QoreStaticMethodIterator i(cls);
+        while (i.next()) {
+            if (name == i.getMethod()->getName()) {
+                return i.getMethod();
+            }
+        }
+        return nullptr;
+    }
+    QoreMethodIterator i(cls);
+    while (i.next()) {
+        const QoreMethod* m = i.getMethod();
+        if (type == 'c') {
+            if (m->getMethodType() == MT_Constructor) {
+                return m;
+            }
+        } else if (m->getMethodType() == MT_Normal && name == m->getName()) {
+            return m;
+        }
+    }
+    return nullptr;
+}
+
+// returns the object in the current process for the given relocation descriptor or nullptr if it cannot be found
+static const void* resolve_byte_code_reloc(const char* desc, const QoreClass& qcls, QoreProgram* pgm) {
+    std::vector<std::string> fields;
+    {
+        const char* p = desc;
+        while (true) {
+            const char* e = strchr(p, '|');
+            if (!e) {
+                fields.emplace_back(p);
+                break;
+            }
+            fields.emplace_back(p, e - p);
+            p = e + 1;
+        }
+    }
+
+    switch (fields[0][0]) {
+        case 'K':
+            return &qcls;
+        case 'P':
+            return getProgram();
+        case 'G':
+            return pgm;
+        case 'C': {
+            if (fields.size() != 3) {
+                return nullptr;
+            }
+            const QoreClass* cls = find_reloc_class(qcls, fields[1]);
+            if (!cls) {
+                return nullptr;
+            }
+            QoreClassConstantIterator i(*cls);
+            while (i.next()) {
+                if (fields[2] == i.get().getName()) {
+                    return &i.get();
+                }
+            }
+            return nullptr;
+        }
+        case 'M':
+        case 'V': {
+            bool variant = fields[0][0] == 'V';
+            if (fields.size() != (variant ? 5 : 4) || fields[1].size() != 1) {
+                return nullptr;
+            }
+            const QoreClass* cls = find_reloc_class(qcls, fields[2]);
+            if (!cls) {
+                return nullptr;
+            }
+            const QoreMethod* m = find_reloc_method(*cls, fields[1][0], fields[3]);
+            if (!m || !variant) {
+                return m;
+            }
+            unsigned idx = (unsigned)strtoul(fields[4].c_str(), nullptr, 10);
+            QoreExternalFunctionIterator vi(*m->getFunction());
+            while (vi.next()) {
+                if (!idx--) {
+                    return vi.getVariant();
+                }
+            }
+            return nullptr;
+        }
+        default:
+            break;
+    }
+    return nullptr;
+}
+
+LocalReference<jbyteArray> JniExternalProgramData::loadCachedByteCode(Env& env, const std::string& key,
+        const QoreClass& qcls, QoreProgram* pgm) {
+    LocalReference<jstring> dir = env.newString(jni_bytecode_cache_dir.c_str());
+    LocalReference<jbyteArray> jkey = env.newByteArray(key.size());
+    env.setBytes(jkey, key.data(), key.size());
+
+    jvalue jargs[4];
+    jargs[0].l = dir;
+    jargs[1].l = jkey;
+    LocalReference<jobjectArray> entry = env.callStaticObjectMethod(Globals::classJavaClassBuilder,
+        Globals::methodJavaClassBuilderLoadCachedByteCode, &jargs[0]).as<jobjectArray>();
+    if (!entry) {
+        return nullptr;
+    }
+
+    LocalReference<jobjectArray> descs = env.getObjectArrayElement(entry, 0).as<jobjectArray>();
+    LocalReference<jlongArray> old_ptrs = env.getObjectArrayElement(entry, 1).as<jlongArray>();
+    LocalReference<jbyteArray> byte_code = env.getObjectArrayElement(entry, 2).as<jbyteArray>();
+    LocalReference<jintArray> indexes = env.getObjectArrayElement(entry, 3).as<jintArray>();
+
+    // find the objects corresponding to the cached pointers in the current process
+    jsize len = env.getArrayLength(descs);
+    std::vector<jlong> new_ptrs(len);
+    for (jsize i = 0; i < len; ++i) {
+        LocalReference<jstring> desc = env.getObjectArrayElement(descs, i).as<jstring>();
+        Env::GetStringUtfChars desc_str(env, desc);
+        const void* ptr = resolve_byte_code_reloc(desc_str.c_str(), qcls, pgm);
+        if (!ptr) {
+            printd(5, "JniExternalProgramData::loadCachedByteCode() '%s': cannot resolve '%s'; ignoring cache " \
+                "entry\n", qcls.getName(), desc_str.c_str());
+            return nullptr;
+        }
+        new_ptrs[i] = reinterpret_cast<jlong>(ptr);
+    }
+
+    LocalReference<jlongArray> jnew_ptrs = env.newLongArray(len);
+    if (len) {
+        env.setArrayRegion(jnew_ptrs, 0, len, &new_ptrs[0]);
+    }
+
+    jargs[0].l = byte_code;
+    jargs[1].l = indexes;
+    jargs[2].l = old_ptrs;
+    jargs[3].l = jnew_ptrs;
+    try {
+        LocalReference<jbyteArray> rv = env.callStaticObjectMethod(Globals::classJavaClassBuilder,
+            Globals::methodJavaClassBuilderRelocateByteCode, &jargs[0]).as<jbyteArray>();
+        printd(5, "JniExternalProgramData::loadCachedByteCode() '%s': using cached bytecode\n", qcls.getName());
+        return rv;
+    } catch (jni::JavaException& e) {
+        // an invalid cache entry is treated like a cache miss
+        e.ignore();
+    }
+    return nullptr;
+}
+
+void JniExternalProgramData::storeCachedByteCode(Env& env, const std::string& key, jbyteArray byte_code,
+        const QoreJavaByteCodeRelocations& new_relocs) {
+    LocalReference<jstring> dir = env.newString(jni_bytecode_cache_dir.c_str());
+    LocalReference<jbyteArray> jkey = env.newByteArray(key.size());
+    env.setBytes(jkey, key.data(), key.size());
+
+    jsize len = new_relocs.ptrs.size();
+    LocalReference<jobjectArray> descs = env.newObjectArray(len, Globals::classString);
+    for (jsize i = 0; i < len; ++i) {
+        LocalReference<jstring> desc = env.newString(new_relocs.descs[i].c_str());
+        env.setObjectArrayElement(descs, i, desc);
+    }
+    LocalReference<jlongArray> ptrs = env.newLongArray(len);
+    if (len) {
+        env.setArrayRegion(ptrs, 0, len, &new_relocs.ptrs[0]);
+    }
+
+    jvalue jargs[5];
+    jargs[0].l = dir;
+    jargs[1].l = jkey;
+    jargs[2].l = descs;
+    jargs[3].l = ptrs;
+    jargs[4].l = byte_code;
+    env.callStaticVoidMethod(Globals::classJavaClassBuilder, Globals::methodJavaClassBuilderStoreCachedByteCode,
+        &jargs[0]);
+}
+
 jobject JniExternalProgramData::getJavaParamList(Env& env, jobject class_loader, const QoreExternalVariant& v,
         unsigned& len, bool is_abstract) {
     const type_vec_t& params = v.getParamTypeList();
@@ -1423,6 +1736,10 @@ int JniExternalProgramData::addConstructorVariant(Env& env, jobject class_loader
             jargs[4].i = qore_jni_get_acc_visibility(v.getAccess());
             jargs[5].l = params;
             jargs[6].z = v.getCodeFlags() & QCF_USES_EXTRA_ARGS;
+            if (relocs) {
+                relocs->add(&m, get_method_reloc_desc(qcls, m));
+                relocs->add(&v, get_variant_reloc_desc(qcls, m, v));
+            }
 
             printd(5, "JniExternalProgramData::addConstructorVariant() %s %s::constructor(%s): adding (len: %d " \
                 "params: %p)\n", v.getAccessString(), qcls.getName(), v.getSignatureText(), len, (jobject)params);
@@ -1480,6 +1797,10 @@ int JniExternalProgramData::addNormalMethodVariant(Env& env, jobject class_loade
             jargs[2].j = reinterpret_cast<jlong>(&m);
             jargs[3].j = reinterpret_cast<jlong>(&v);
             jargs[4].i = qore_jni_get_acc_visibility(v.getAccess());
+            if (relocs) {
+                relocs->add(&m, get_method_reloc_desc(qcls, m));
+                relocs->add(&v, get_variant_reloc_desc(qcls, m, v));
+            }
             LocalReference<jobject> return_type = getJavaTypeDefinition(env, class_loader, v.getReturnTypeInfo());
             jargs[5].l = return_type;
             jargs[6].l = params;
@@ -1527,6 +1848,11 @@ int JniExternalProgramData::addStaticMethodVariant(Env& env, jobject class_loade
             jargs[2].j = (jlong)getProgram(),
             jargs[3].j = reinterpret_cast<jlong>(&m);
             jargs[4].j = reinterpret_cast<jlong>(&v);
+            if (relocs) {
+                relocs->add(getProgram(), "P");
+                relocs->add(&m, get_method_reloc_desc(qcls, m));
+                relocs->add(&v, get_variant_reloc_desc(qcls, m, v));
+            }
             jargs[5].i = qore_jni_get_acc_visibility(v.getAccess());
             LocalReference<jobject> return_type = getJavaTypeDefinition(env, class_loader, v.getReturnTypeInfo());
             jargs[6].l = return_type;
@@ -2091,6 +2417,13 @@ int JniExternalProgramData::addClassConstants(Env& env, jstring jname, const Qor
         jargs[3].l = const_type;
         jargs[4].j = (jlong)&c;
         jargs[5].l = ilist;
+        if (relocs) {
+            std::string desc = "C|";
+            desc += qcls.getNamespacePath();
+            desc += '|';
+            desc += c.getName();
+            relocs->add(&c, std::move(desc));
+        }
         bb = env.callStaticObjectMethod(Globals::classJavaClassBuilder, Globals::methodJavaClassBuilderAddStaticField,
             &jargs[0]);
     }
@@ -2101,6 +2434,9 @@ int JniExternalProgramData::addClassConstants(Env& env, jstring jname, const Qor
     jargs[1].l = jname;
     jargs[2].j = (long)pgm;
     jargs[3].l = ilist;
+    if (relocs) {
+        relocs->add(pgm, "G");
+    }
 
     bb = env.callStaticObjectMethod(Globals::classJavaClassBuilder, Globals::methodJavaClassBuilderCreateStaticInitializer,
         &jargs[0]);
@@ -2108,6 +2444,31 @@ int JniExternalProgramData::addClassConstants(Env& env, jstring jname, const Qor
     return 0;
 }
 
+// saves the Java binary name in the Qore class
+static void save_java_bin_name(Env& env, const QoreClass* qcls, jstring jname) {
+    // NOTE this must come last as using Env::GetStringUtfChars on a java string destroys the string
+    Env::GetStringUtfChars jname_str(env, jname);
+    printd(5, "save_java_bin_name() saving class name %p %s: %s\n", qcls, qcls->getName(), jname_str.c_str());
+    const_cast<QoreClass*>(qcls)->setKeyValueIfNotSet(JNI_CK_JAVA_BIN_NAME, jname_str.c_str());
+}
+
+// sets the relocation recorder for bytecode generation and restores the previous one when destroyed
+class ByteCodeRelocationHelper {
+public:
+    DLLLOCAL ByteCodeRelocationHelper(QoreJavaByteCodeRelocations*& relocs, QoreJavaByteCodeRelocations* new_relocs)
+            : relocs(relocs), old_relocs(relocs) {
+        relocs = new_relocs;
+    }
+
+    DLLLOCAL ~ByteCodeRelocationHelper() {
+        relocs = old_relocs;
+    }
+
+private:
+    QoreJavaByteCodeRelocations*& relocs;
+    QoreJavaByteCodeRelocations* old_relocs;
+};
+
 LocalReference<jbyteArray> JniExternalProgramData::generateByteCodeIntern(Env& env, jobject class_loader,
         const QoreClass* qcls, QoreProgram* pgm, jstring jname) {
     //printd(5, "JniExternalProgramData::generateByteCodeIntern() '%s'\n", qcls->getName());
@@ -2160,6 +2521,33 @@ LocalReference<jbyteArray> JniExternalProgramData::generateByteCodeIntern(Env& e
         jname = njname;
     }
 
+    // check the persistent bytecode cache
+    std::string cache_key;
+    if (!jni_bytecode_cache_dir.empty()) {
+        try {
+            cache_key = get_byte_code_cache_key(env, *qcls, jname, class_loader, parent_ptr);
+        } catch (jni::JavaException& e) {
+            // the class is not cached if the parent classes cannot be read
+            e.ignore();
+        }
+        if (!cache_key.empty()) {
+            LocalReference<jbyteArray> rv = loadCachedByteCode(env, cache_key, *qcls, pgm);
+            if (rv) {
+                if (has_jname) {
+                    save_java_bin_name(env, qcls, jname);
+                }
+                return rv;
+            }
+        }
+    }
+
+    // record native pointers embedded in the bytecode if it will be cached
+    QoreJavaByteCodeRelocations new_relocs;
+    ByteCodeRelocationHelper reloc_helper(relocs, cache_key.empty() ? nullptr : &new_relocs);
+    if (relocs) {
+        relocs->add(qcls, "K");
+    }
+
     std::vector<jvalue> jargs(4);
     jargs[0].l = jname;
     jargs[1].l = parent_ptr;
@@ -2236,13 +2624,13 @@ LocalReference<jbyteArray> JniExternalProgramData::generateByteCodeIntern(Env& e
 
     strset.erase(qpath);
 
+    if (relocs && rv) {
+        storeCachedByteCode(env, cache_key, rv, new_relocs);
+    }
+
     // save Java bin name in Qore class if necessary
     if (has_jname) {
-        // NOTE this must come last as using Env::GetStringUtfChars on a java string destroys the string
-        Env::GetStringUtfChars jname_str(env, jname);
-        printd(5, "JniExternalProgramData::generateByteCodeIntern() saving class name %p %s: %s\n", qcls,
-            qcls->getName(), jname_str.c_str());
-        const_cast<QoreClass*>(qcls)->setKeyValueIfNotSet(JNI_CK_JAVA_BIN_NAME, jname_str.c_str());
+        save_java_bin_name(env, qcls, jname);
     }
 
     printd(5, "JniExternalProgramData::generateByteCodeIntern() %s rv: %p cl: %x (this->cl: %x)\n", qcls->getName(),
@@ -2385,9 +2773,7 @@ jarray QoreJniClassMap::getJavaArrayIntern(Env& env, const QoreListNode* l, jcla
     LocalReference<jarray> array = Array::getNew(elementType, cls, l->size());
 
     // now populate array
-    for (jsize i = 0; i < static_cast<jsize>(l->size()); ++i) {
-        Array::set(array, elementType, cls, i, l->retrieveEntry(i), jpc);
-    }
+    Array::setAll(env, array, elementType, cls, l, 0, jpc);
 
     return array.release();
 }
@@ -2507,9 +2893,8 @@ JniExternalProgramData::JniExternalProgramData(QoreNamespace* n_jni, QoreProgram
         // make byte array
         LocalReference<jbyteArray> jbyte_code =
             env.newByteArray(java_org_qore_jni_QoreJavaDynamicApi_class_len).as<jbyteArray>();
-        for (jsize i = 0; (unsigned)i < java_org_qore_jni_QoreJavaDynamicApi_class_len; ++i) {
-            env.setByteArrayElement(jbyte_code, i, java_org_qore_jni_QoreJavaDynamicApi_class[i]);
-        }
+        env.setBytes(jbyte_code, java_org_qore_jni_QoreJavaDynamicApi_class,
+            java_org_qore_jni_QoreJavaDynamicApi_class_len);
 
         std::vector<jvalue> jargs(4);
         jargs[0].l = jname;
@@ -2523,8 +2908,12 @@ JniExternalProgramData::JniExternalProgramData(QoreNamespace* n_jni, QoreProgram
             &jargs[0]).as<jclass>().makeGlobal();
         methodQoreJavaDynamicApiInvokeMethod = env.getStaticMethod(dynamicApi, "invokeMethod",
             "(Ljava/lang/reflect/Method;Ljava/lang/Object;[Ljava/lang/Object;)Ljava/lang/Object;");
-        methodQoreJavaDynamicApiInvokeMethodNonvirtual = env.getStaticMethod(dynamicApi, "invokeMethodNonvirtual",
-            "(Ljava/lang/reflect/Method;Ljava/lang/Object;[Ljava/lang/Object;)Ljava/lang/Object;");
+        methodQoreJavaDynamicApiGetSpecialHandle = env.getStaticMethod(dynamicApi, "getSpecialHandle",
+            "(Ljava/lang/reflect/Method;)Ljava/lang/invoke/MethodHandle;");
+        methodQoreJavaDynamicApiInvokeSpecial = env.getStaticMethod(dynamicApi, "invokeSpecial",
+            "(Ljava/lang/invoke/MethodHandle;Ljava/lang/Object;[Ljava/lang/Object;)Ljava/lang/Object;");
+        methodQoreJavaDynamicApiIsCallerSensitive = env.getStaticMethod(dynamicApi, "isCallerSensitive",
+            "(Ljava/lang/reflect/Method;)Z");
         methodQoreJavaDynamicApiGetField = env.getStaticMethod(dynamicApi, "getField",
             "(Ljava/lang/reflect/Field;Ljava/lang/Object;)Ljava/lang/Object;");
 
@@ -2533,6 +2922,10 @@ JniExternalProgramData::JniExternalProgramData(QoreNamespace* n_jni, QoreProgram
             (jclass)Globals::classQoreJavaClassBase);
     }
 
+    if (jni_identity_cache_size) {
+        identityCache.reset(new JavaIdentityCache(jni_identity_cache_size));
+    }
+
     // setup classpath
     TempString classpath(SystemEnvironment::get("QORE_JNI_CLASSPATH"));
     if (classpath) {
@@ -2545,10 +2938,14 @@ JniExternalProgramData::JniExternalProgramData(const JniExternalProgramData& par
         // reuse the same dynamic API as the parent
         dynamicApi(GlobalReference<jclass>::fromLocal(parent.dynamicApi.toLocal())),
         methodQoreJavaDynamicApiInvokeMethod(parent.methodQoreJavaDynamicApiInvokeMethod),
-        methodQoreJavaDynamicApiInvokeMethodNonvirtual(parent.methodQoreJavaDynamicApiInvokeMethodNonvirtual),
+        methodQoreJavaDynamicApiGetSpecialHandle(parent.methodQoreJavaDynamicApiGetSpecialHandle),
+        methodQoreJavaDynamicApiInvokeSpecial(parent.methodQoreJavaDynamicApiInvokeSpecial),
+        methodQoreJavaDynamicApiIsCallerSensitive(parent.methodQoreJavaDynamicApiIsCallerSensitive),
         methodQoreJavaDynamicApiGetField(parent.methodQoreJavaDynamicApiGetField),
         override_compat_types(parent.override_compat_types),
-        compat_types(parent.compat_types) {
+        compat_types(parent.compat_types),
+        override_lazy_hashes(parent.override_lazy_hashes),
+        lazy_hashes(parent.lazy_hashes) {
     // clone the parent's classLoader
     {
         jvalue jargs[2];
@@ -2558,6 +2955,10 @@ JniExternalProgramData::JniExternalProgramData(const JniExternalProgramData& par
             &jargs[0]).makeGlobal();
     }
 
+    if (jni_identity_cache_size) {
+        identityCache.reset(new JavaIdentityCache(jni_identity_cache_size));
+    }
+
     // copy the parent's class map to this one
     jcmap = parent.jcmap;
     // find Jni namespace in new Program if present
@@ -2572,6 +2973,9 @@ JniExternalProgramData::~JniExternalProgramData() {
     try {
         Env env;
         env.callVoidMethod(classLoader, Globals::methodQoreURLClassLoaderClearProgramPtr, nullptr);
+        for (auto& i : peerMap) {
+            env.deleteWeakGlobalRef(i.second);
+        }
     } catch (UnableToAttachException& e) {
         // ignore error - raised when destructions is run after the JVM has shut down
     }
@@ -2618,6 +3022,16 @@ bool JniExternalProgramData::compatTypes() {
     return jpc->getCompatTypes();
 }
 
+bool JniExternalProgramData::lazyCollections() {
+    JniExternalProgramData* jpc = jni_get_context_unconditional();
+    return jpc->getLazyCollections();
+}
+
+bool JniExternalProgramData::lazyHashes() {
+    JniExternalProgramData* jpc = jni_get_context_unconditional();
+    return jpc->getLazyHashes();
+}
+
 LocalReference<jclass> JniExternalProgramData::getClassForValue(const QoreObject* o) {
     if (!o->isValid()) {
         return nullptr;
@@ -2634,7 +3048,20 @@ LocalReference<jclass> JniExternalProgramData::getClassForValue(const QoreObject
     return getJavaClassForQoreClass(env, o->getClass());
 }
 
-LocalReference<jclass> JniExternalProgramData::getJavaClassForQoreClass(Env& env, const QoreClass* qc) {
+LocalReference<jclass> JniExternalProgramData::getJavaClassForQoreClass(Env& env, const QoreClass* qc,
+        jmethodID* ctor) {
+    qore_classid_t id = qc->getID();
+    {
+        QoreAutoRWReadLocker al(qcmap_lock);
+        qcmap_t::const_iterator i = qcmap.find(qc);
+        if (i != qcmap.end() && i->second.id == id) {
+            if (ctor) {
+                *ctor = i->second.ctor;
+            }
+            return env.newLocalRef(i->second.jcls);
+        }
+    }
+
     // ensure that class generation is atomic
     AutoLocker al(codeGenLock);
 
@@ -2658,9 +3085,30 @@ LocalReference<jclass> JniExternalProgramData::getJavaClassForQoreClass(Env& env
         //  qc->getName(), (jclass)i->second);
     }
 
+    // cache the class for lookups without the class hash
+    {
+        QoreAutoRWWriteLocker wl(qcmap_lock);
+        QoreJavaClassInfo info = {id, (jclass)i->second, 0};
+        std::pair<qcmap_t::iterator, bool> r = qcmap.insert(qcmap_t::value_type(qc, info));
+        if (!r.second && (r.first->second.id != id || r.first->second.jcls != info.jcls)) {
+            r.first->second = info;
+        }
+        if (ctor) {
+            *ctor = r.first->second.ctor;
+        }
+    }
+
     return i->second.toLocal();
 }
 
+void JniExternalProgramData::setJavaObjectCtor(Env& env, const QoreClass* qc, jclass jcls, jmethodID ctor) {
+    QoreAutoRWWriteLocker al(qcmap_lock);
+    qcmap_t::iterator i = qcmap.find(qc);
+    if (i != qcmap.end() && i->second.id == qc->getID() && env.isSameObject(i->second.jcls, jcls)) {
+        i->second.ctor = ctor;
+    }
+}
+
 LocalReference<jobject> JniExternalProgramData::getJavaObject(const QoreObject* o) {
     if (!o->isValid()) {
         return nullptr;
@@ -2672,9 +3120,29 @@ LocalReference<jobject> JniExternalProgramData::getJavaObject(const QoreObject*
     }
 
     Env env;
-    LocalReference<jclass> jcls = getJavaClassForQoreClass(env, o->getSurfaceClass());
+    {
+        AutoLocker al(peerLock);
+        peer_map_t::iterator i = peerMap.find(o);
+        if (i != peerMap.end()) {
+            LocalReference<jobject> peer = env.newLocalRef<jobject>(i->second);
+            // the cached peer can only be reused if it has not been collected and has not been released or
+            // destroyed; a peer still holding its pointer also holds a weak reference to the object, so the
+            // pointer cannot have been reused for another object
+            if (peer && env.callLongMethod(peer, Globals::methodQoreObjectBaseGet, nullptr)
+                == reinterpret_cast<jlong>(o)) {
+                return peer;
+            }
+        }
+    }
+
+    const QoreClass* qc = o->getSurfaceClass();
+    jmethodID ctor;
+    LocalReference<jclass> jcls = getJavaClassForQoreClass(env, qc, &ctor);
+    if (!ctor) {
+        ctor = env.getMethod(jcls, "<init>", "(Lorg/qore/jni/QoreJavaObjectPtr;)V");
+        setJavaObjectCtor(env, qc, jcls, ctor);
+    }
     // return a new Java object with a weak reference to the actual Qore object
-    jmethodID ctor = env.getMethod(jcls, "<init>", "(Lorg/qore/jni/QoreJavaObjectPtr;)V");
     o->tRef();
     try {
         jvalue arg;
@@ -2683,10 +3151,45 @@ LocalReference<jobject> JniExternalProgramData::getJavaObject(const QoreObject*
             &arg);
 
         arg.l = jarg;
-        return env.newObject(jcls, ctor, &arg);
+        LocalReference<jobject> peer = env.newObject(jcls, ctor, &arg);
+        savePeer(env, o, peer);
+        return peer;
     } catch (jni::Exception& e) {
         const_cast<QoreObject*>(o)->tDeref();
         throw;
     }
 }
+
+void JniExternalProgramData::savePeer(Env& env, const QoreObject* o, jobject peer) {
+    AutoLocker al(peerLock);
+    jweak ref;
+    try {
+        ref = env.newWeakGlobalRef(peer);
+    } catch (jni::Exception& e) {
+        // the peer is returned uncached if the reference cannot be created
+        e.ignore();
+        return;
+    }
+    std::pair<peer_map_t::iterator, bool> r = peerMap.insert(peer_map_t::value_type(o, ref));
+    if (!r.second) {
+        env.deleteWeakGlobalRef(r.first->second);
+        r.first->second = ref;
+    }
+
+    if (peerMap.size() >= peerPurgeSize) {
+        // remove entries for peers that have been collected
+        for (peer_map_t::iterator i = peerMap.begin(), e = peerMap.end(); i != e;) {
+            if (env.isSameObject(i->second, nullptr)) {
+                env.deleteWeakGlobalRef(i->second);
+                i = peerMap.erase(i);
+            } else {
+                ++i;
+            }
+        }
+        peerPurgeSize = peerMap.size() * 2;
+        if (peerPurgeSize < PeerPurgeMinSize) {
+            peerPurgeSize = PeerPurgeMinSize;
+        }
+    }
+}
 }
@@ -29,21 +29,42 @@
 #include "Env.h"
 #include "Class.h"
 #include "JniQoreClass.h"
+#include "JavaIdentityCache.h"
 
 #include <set>
 #include <map>
+#include <memory>
+#include <unordered_map>
+#include <string>
+#include <vector>
 #include <mutex>
 #include <condition_variable>
 
 typedef std::set<std::string> strset_t;
 
 DLLLOCAL QoreClass* initJavaArrayClass(QoreNamespace& ns);
+DLLLOCAL QoreClass* initJavaMapViewClass(QoreNamespace& ns);
+DLLLOCAL QoreClass* initJavaListViewClass(QoreNamespace& ns);
 DLLLOCAL QoreClass* initQoreInvocationHandlerClass(QoreNamespace& ns);
 
 DLLLOCAL void init_jni_functions(QoreNamespace& ns);
 DLLLOCAL QoreClass* jni_class_handler(QoreNamespace* ns, const char* cname);
 
 DLLLOCAL extern bool jni_compat_types;
+// global lazy collection conversion option
+DLLLOCAL extern bool jni_lazy_collections;
+// global lazy class population option
+DLLLOCAL extern bool jni_lazy_classes;
+// persistent bytecode cache directory; empty if the bytecode cache is disabled
+DLLLOCAL extern std::string jni_bytecode_cache_dir;
+// maximum number of Java objects in each Program's identity cache; 0 if the identity cache is disabled
+DLLLOCAL extern size_t jni_identity_cache_size;
+// true if binary values are passed to untyped Java parameters as direct ByteBuffer objects
+DLLLOCAL extern bool jni_byte_buffers;
+// true if hashes and lists are converted to Java with a single call (see DataMarshaller)
+DLLLOCAL extern bool jni_marshal_data;
+// true if hashes are passed to Java as lazy org.qore.jni.QoreHashProxy objects
+DLLLOCAL extern bool jni_lazy_hashes;
 
 namespace jni {
 
@@ -123,7 +144,9 @@ public:
 
     DLLLOCAL void destroy(ExceptionSink& xsink);
 
-    DLLLOCAL QoreValue getValue(LocalReference<jobject>& jobj, QoreProgram* pgm, bool compat_types);
+    //! Wraps a Java object that has no direct %Qore equivalent in a %Qore object of the corresponding class
+    DLLLOCAL QoreValue getValue(Env& env, LocalReference<jobject>& jobj, LocalReference<jclass>& jc,
+            QoreProgram* pgm);
 
     DLLLOCAL const QoreTypeInfo* getQoreType(jclass cls, const QoreTypeInfo*& altType,
             QoreProgram* pgm = nullptr, bool literal = false);
@@ -173,6 +196,13 @@ public:
 
     DLLLOCAL static LocalReference<jclass> getPrimitiveType(qore_type_t t);
 
+    //! populates the given class and all its Java parent classes with methods and members if not already done
+    /** used when lazy class population is enabled; classes that are only referenced as parameter, return, or field
+        types are created with their class hierarchy only and are populated here when resolved by name or when a
+        Java object of the class is first wrapped in a Qore object
+    */
+    DLLLOCAL void ensurePopulated(JniQoreClass& qc, QoreProgram* pgm);
+
 protected:
     // map of java class names to const QoreTypeInfo ptrs
     typedef std::map<const std::string, const QoreTypeInfo*> jtmap_t;
@@ -268,6 +298,24 @@ private:
     LocalReference<jobject> plist;
 };
 
+//! native pointers embedded in generated bytecode
+/** each pointer is stored with a descriptor that allows the same Qore object to be found in another process, so
+    that bytecode loaded from the persistent bytecode cache can be relocated
+*/
+struct QoreJavaByteCodeRelocations {
+    std::vector<jlong> ptrs;
+    std::vector<std::string> descs;
+
+    DLLLOCAL void add(const void* ptr, std::string&& desc) {
+        // null pointers do not need to be relocated
+        if (!ptr) {
+            return;
+        }
+        ptrs.push_back(reinterpret_cast<jlong>(ptr));
+        descs.push_back(std::move(desc));
+    }
+};
+
 class JniExternalProgramData : public AbstractQoreProgramExternalData, public QoreJniClassMapBase {
 public:
     DLLLOCAL JniExternalProgramData(QoreNamespace* n_jni, QoreProgram* pgm);
@@ -297,9 +345,19 @@ public:
         return methodQoreJavaDynamicApiInvokeMethod;
     }
 
-    DLLLOCAL jmethodID getInvokeMethodNonvirtualId() const {
-        assert(methodQoreJavaDynamicApiInvokeMethodNonvirtual);
-        return methodQoreJavaDynamicApiInvokeMethodNonvirtual;
+    DLLLOCAL jmethodID getSpecialHandleId() const {
+        assert(methodQoreJavaDynamicApiGetSpecialHandle);
+        return methodQoreJavaDynamicApiGetSpecialHandle;
+    }
+
+    DLLLOCAL jmethodID getInvokeSpecialId() const {
+        assert(methodQoreJavaDynamicApiInvokeSpecial);
+        return methodQoreJavaDynamicApiInvokeSpecial;
+    }
+
+    DLLLOCAL jmethodID getIsCallerSensitiveId() const {
+        assert(methodQoreJavaDynamicApiIsCallerSensitive);
+        return methodQoreJavaDynamicApiIsCallerSensitive;
     }
 
     DLLLOCAL jmethodID getFieldId() const {
@@ -330,6 +388,24 @@ public:
         return override_compat_types ? compat_types : jni_compat_types;
     }
 
+    DLLLOCAL void overrideLazyCollections(bool lazy_collections) {
+        override_lazy_collections = true;
+        this->lazy_collections = lazy_collections;
+    }
+
+    DLLLOCAL bool getLazyCollections() const {
+        return override_lazy_collections ? lazy_collections : jni_lazy_collections;
+    }
+
+    DLLLOCAL void overrideLazyHashes(bool lazy_hashes) {
+        override_lazy_hashes = true;
+        this->lazy_hashes = lazy_hashes;
+    }
+
+    DLLLOCAL bool getLazyHashes() const {
+        return override_lazy_hashes ? lazy_hashes : jni_lazy_hashes;
+    }
+
     DLLLOCAL void setSaveObjectCallback(const ResolvedCallReferenceNode* save_object_callback) {
         if (this->save_object_callback) {
             this->save_object_callback->deref(nullptr);
@@ -351,11 +427,28 @@ public:
         if (save_object_callback) {
             save_object_callback->deref(nullptr);
         }
+        if (identityCache) {
+            try {
+                Env env;
+                identityCache->clear(env);
+            } catch (UnableToAttachException& e) {
+                // ignore error - raised when destructions is run after the JVM has shut down
+            }
+        }
         delete this;
     }
 
+    //! Returns the identity cache for Java objects returned to Qore or nullptr if the cache is disabled
+    DLLLOCAL JavaIdentityCache* getIdentityCache() const {
+        return identityCache.get();
+    }
+
     DLLLOCAL void clearCompilationCache() {
         //printd(5, "JniExternalProgramData::clearCompilationCache() clearing %d entries\n", (int)q2jmap.size());
+        {
+            QoreAutoRWWriteLocker al(qcmap_lock);
+            qcmap.clear();
+        }
         q2jmap.clear();
     }
 
@@ -365,13 +458,25 @@ public:
 
     DLLLOCAL LocalReference<jclass> getClassForValue(const QoreObject* o);
 
-    DLLLOCAL LocalReference<jclass> getJavaClassForQoreClass(Env& env, const QoreClass* qc);
+    //! Returns the Java class for the given Qore class, generating it if necessary
+    /** @param ctor if not null, receives the cached \c <init>(QoreJavaObjectPtr) constructor of the class or 0 if
+        it has not been resolved yet
+    */
+    DLLLOCAL LocalReference<jclass> getJavaClassForQoreClass(Env& env, const QoreClass* qc,
+            jmethodID* ctor = nullptr);
+
+    //! Caches the \c <init>(QoreJavaObjectPtr) constructor for the generated Java class of the given Qore class
+    DLLLOCAL void setJavaObjectCtor(Env& env, const QoreClass* qc, jclass jcls, jmethodID ctor);
 
     // Returns a Java object corresponding to the given Qore object
-    /** A Java class for the given Qore class is created dynamically if necessary
+    /** A Java class for the given Qore class is created dynamically if necessary; the same Java peer is returned for
+        the same Qore object as long as the peer is reachable in Java
      */
     DLLLOCAL LocalReference<jobject> getJavaObject(const QoreObject* o);
 
+    // Caches the Java peer for the given Qore object
+    DLLLOCAL void savePeer(Env& env, const QoreObject* o, jobject peer);
+
     DLLLOCAL static JniExternalProgramData* setContext(QoreProgram*& pgm) {
         Env env;
         return setContext(env, pgm);
@@ -383,6 +488,10 @@ public:
 
     DLLLOCAL static bool compatTypes();
 
+    DLLLOCAL static bool lazyCollections();
+
+    DLLLOCAL static bool lazyHashes();
+
 protected:
     // Jni namespace pointer for the current Program
     QoreNamespace* jni;
@@ -395,8 +504,12 @@ protected:
 
     // QoreJavaDynamicApi.invokeNethod()
     jmethodID methodQoreJavaDynamicApiInvokeMethod = 0;
-    // QoreJavaDynamicApi.invokeNethodNonvirtual()
-    jmethodID methodQoreJavaDynamicApiInvokeMethodNonvirtual = 0;
+    // QoreJavaDynamicApi.getSpecialHandle()
+    jmethodID methodQoreJavaDynamicApiGetSpecialHandle = 0;
+    // QoreJavaDynamicApi.invokeSpecial()
+    jmethodID methodQoreJavaDynamicApiInvokeSpecial = 0;
+    // QoreJavaDynamicApi.isCallerSensitive()
+    jmethodID methodQoreJavaDynamicApiIsCallerSensitive = 0;
     // QoreJavaDynamicApi.getField()
     jmethodID methodQoreJavaDynamicApiGetField = 0;
 
@@ -409,19 +522,74 @@ protected:
     typedef std::map<std::string, GlobalReference<jclass>> q2jmap_t;
     q2jmap_t q2jmap;
 
+    // cached generated Java class and constructor for a Qore class
+    struct QoreJavaClassInfo {
+        // the ID of the Qore class; detects a QoreClass pointer being reused for another class
+        qore_classid_t id;
+        // the generated Java class; the global reference is owned by q2jmap
+        jclass jcls;
+        // <init>(QoreJavaObjectPtr) constructor, or 0 if not resolved yet
+        jmethodID ctor;
+    };
+
+    // read-mostly map of Qore classes to generated Java classes
+    /** lets classes already generated be found without calculating the class hash or taking codeGenLock; qcmap_lock
+        must be held when accessing this data, and it must be cleared whenever q2jmap is cleared
+     */
+    typedef std::unordered_map<const QoreClass*, QoreJavaClassInfo> qcmap_t;
+    QoreRWLock qcmap_lock;
+    qcmap_t qcmap;
+
+    // relocations for the class currently being generated for the bytecode cache, if any
+    /** codeGenLock must be held when accessing this data
+     */
+    QoreJavaByteCodeRelocations* relocs = nullptr;
+
     // map of paths to fake "$" Qore classes
     typedef std::map<std::string, QoreBuiltinClass*> fake_cls_map_t;
     fake_cls_map_t fake_cls_map;
 
+    // number of cached Java peers at which entries for collected peers are purged
+    static constexpr size_t PeerPurgeMinSize = 1024;
+
+    // cached Java peers for Qore objects of non-Java classes; QoreObject -> weak global reference to the peer
+    /** peerLock must be held when accessing this data
+     */
+    typedef std::unordered_map<const QoreObject*, jweak> peer_map_t;
+    QoreThreadLock peerLock;
+    peer_map_t peerMap;
+    size_t peerPurgeSize = PeerPurgeMinSize;
+
+    // identity cache for Java objects returned to Qore; null if disabled
+    std::unique_ptr<JavaIdentityCache> identityCache;
+
     // override compat-types
     bool override_compat_types = false;
     // compat-types values
     bool compat_types = false;
 
+    // override lazy-collections
+    bool override_lazy_collections = false;
+    // lazy-collections value
+    bool lazy_collections = false;
+
+    // override lazy-hashes
+    bool override_lazy_hashes = false;
+    // lazy-hashes value
+    bool lazy_hashes = false;
+
     // returns Java byte code (byte[]) for the given Qore class
     DLLLOCAL LocalReference<jbyteArray> generateByteCodeIntern(Env& env, jobject class_loader,
         const QoreClass* qcls, QoreProgram* pgm, jstring jname = nullptr);
 
+    // returns relocated bytecode for the given Qore class from the persistent bytecode cache, if present
+    DLLLOCAL LocalReference<jbyteArray> loadCachedByteCode(Env& env, const std::string& key, const QoreClass& qcls,
+        QoreProgram* pgm);
+
+    // stores generated bytecode and its relocations in the persistent bytecode cache
+    DLLLOCAL void storeCachedByteCode(Env& env, const std::string& key, jbyteArray byte_code,
+        const QoreJavaByteCodeRelocations& new_relocs);
+
     // returns Java byte code (byte[]) for a wrapper class for Qore functions implemneted as static methods
     DLLLOCAL LocalReference<jbyteArray> generateFunctionClassIntern(Env& env, jobject class_loader, QoreProgram* pgm,
         jstring jname, const char* ns_path = nullptr);
@@ -25,26 +25,77 @@
 //------------------------------------------------------------------------------
 
 #include "QoreToJava.h"
+#include "JavaKeyCache.h"
+#include "StringTranscoder.h"
+#include "NumberConverter.h"
+#include "DataMarshaller.h"
+
+#include <limits>
+#include <memory>
+#include <unordered_map>
 
 namespace jni {
 
+namespace {
+//! cached map conversion info for a target class
+struct MapTargetEntry {
+    //! weak reference to the requested class, so that cached classes can still be unloaded
+    jweak cls;
+    //! true if the requested class cannot be instantiated as a map and org.qore.jni.Hash is used instead
+    bool use_hash;
+    jmethodID ctor;
+    jmethodID sized_ctor;
+    jmethodID put;
+    bool bulk;
+};
+
+// maps class identity hash codes to cache entries
+typedef std::unordered_multimap<jint, MapTargetEntry> mtmap_t;
+
+// the maximum number of cached classes before entries for unloaded classes are purged
+static constexpr size_t MapTargetCacheMax = 1024;
+
+static QoreRWLock mt_lock;
+static mtmap_t mt_map;
+
+// interned hash keys; only created if enabled with the "key-cache" module option
+static std::unique_ptr<JavaKeyCache> key_cache;
+
+// java.time.ZoneOffset objects by UTC offset in seconds; there are few distinct offsets in practice
+typedef std::unordered_map<int, GlobalReference<jobject>> zomap_t;
+static QoreRWLock zo_lock;
+static zomap_t zo_map;
+
+// binary values exposed to Java as direct buffers by memory address; a binary value has one entry for each buffer
+typedef std::unordered_multimap<const void*, BinaryNode*> dbmap_t;
+static QoreThreadLock db_lock;
+static dbmap_t db_map;
+
+// the memory of empty direct buffers; NewDirectByteBuffer() does not accept a null address
+static char empty_buffer;
+}
+
 static jstring jni_string_to_jstring(const QoreStringNode& qstr) {
-    ModifiedUtf8String str(qstr);
     Env env;
-    return env.newString(str.c_str()).release();
+    return StringTranscoder::toJava(env, qstr).release();
 }
 
 static jobject jni_date_to_jobject(const DateTimeNode& qdate) {
     Env env;
 
     if (qdate.isAbsolute()) {
-        QoreString str;
-        qdate.format(str, "YYYY-MM-DDTHH:mm:SS.xxZ");
-
-        LocalReference<jstring> date_str = env.newString(str.c_str());
-        std::vector<jvalue> jargs(1);
-        jargs[0].l = date_str;
-        return env.callStaticObjectMethod(Globals::classZonedDateTime, Globals::methodZonedDateTimeParse, &jargs[0]).release();
+        // the date is created with a fixed UTC offset, as it was when it was converted as an ISO-8601 string
+        jvalue jargs[2];
+        jargs[0].j = qdate.getEpochSecondsUTC();
+        jargs[1].j = qdate.getMicrosecond() * 1000;
+        LocalReference<jobject> instant = env.callStaticObjectMethod(Globals::classInstant,
+            Globals::methodInstantOfEpochSecond, jargs);
+
+        LocalReference<jobject> offset = QoreToJava::getZoneOffset(env, qdate.getUTCOffset());
+        jargs[0].l = instant;
+        jargs[1].l = offset;
+        return env.callStaticObjectMethod(Globals::classZonedDateTime, Globals::methodZonedDateTimeOfInstant,
+            jargs).release();
     }
 
     // return QoreRelativeTime object
@@ -63,35 +114,19 @@ static jobject jni_date_to_jobject(const DateTimeNode& qdate) {
 }
 
 static jobject jni_number_to_jobject(const QoreNumberNode& num) {
-    QoreString str;
-    num.toString(str);
-
     Env env;
-    LocalReference<jstring> num_str = env.newString(str.c_str());
-    std::vector<jvalue> jargs(1);
-    jargs[0].l = num_str;
-    return env.newObject(Globals::classBigDecimal, Globals::ctorBigDecimal, &jargs[0]).release();
+    return NumberConverter::toJava(env, num).release();
 }
 
 jobject QoreToJava::toAnyObject(const QoreValue& value, JniExternalProgramData* jpc) {
     Env env;
     switch (value.getType()) {
-        case NT_BOOLEAN: {
-            jvalue arg;
-            arg.z = value.getAsBool();
-            return env.newObject(Globals::classBoolean, Globals::ctorBoolean, &arg).release();
-        }
-        case NT_INT: {
-            jvalue arg;
-            int64 v = value.getAsBigInt();
-            arg.j = v;
-            return env.newObject(Globals::classLong, Globals::ctorLong, &arg).release();
-        }
-        case NT_FLOAT: {
-            jvalue arg;
-            arg.d = value.getAsFloat();
-            return env.newObject(Globals::classDouble, Globals::ctorDouble, &arg).release();
-        }
+        case NT_BOOLEAN:
+            return Globals::boxBoolean(env, value.getAsBool()).release();
+        case NT_INT:
+            return Globals::boxLong(env, value.getAsBigInt()).release();
+        case NT_FLOAT:
+            return Globals::boxDouble(env, value.getAsFloat()).release();
         case NT_STRING: {
             return jni_string_to_jstring(*value.get<QoreStringNode>());
         }
@@ -119,9 +154,19 @@ jobject QoreToJava::toAnyObject(const QoreValue& value, JniExternalProgramData*
             return qjcm.getJavaClosure(call);
         }
         case NT_HASH: {
+            if (JniExternalProgramData::lazyHashes()) {
+                return makeHashProxy(*value.get<QoreHashNode>(), jpc);
+            }
+            if (jni_marshal_data) {
+                Env env;
+                return DataMarshaller::toJava(env, value, jpc).release();
+            }
             return makeMap(*value.get<QoreHashNode>(), Globals::classHash, jpc);
         }
         case NT_BINARY: {
+            if (jni_byte_buffers) {
+                return makeDirectByteBuffer(*value.get<BinaryNode>());
+            }
             return makeByteArray(*value.get<BinaryNode>());
         }
 
@@ -129,6 +174,10 @@ jobject QoreToJava::toAnyObject(const QoreValue& value, JniExternalProgramData*
         case NT_NULL:
             return nullptr;
         case NT_LIST:
+            if (jni_marshal_data) {
+                Env env;
+                return DataMarshaller::toJava(env, value, jpc).release();
+            }
             return Array::toJava(value.get<QoreListNode>(), 0, jpc).release();
     }
     QoreStringMaker desc("XX(%d) don't know how to convert a value of type '%s' to a Java object (expecting " \
@@ -136,51 +185,50 @@ jobject QoreToJava::toAnyObject(const QoreValue& value, JniExternalProgramData*
     throw BasicException(desc.c_str());
 }
 
-jobject QoreToJava::toObject(const QoreValue& value, jclass cls, JniExternalProgramData* jpc) {
+jobject QoreToJava::toObject(const QoreValue& value, jclass cls, TargetKind kind, JniExternalProgramData* jpc) {
     if (value.isNullOrNothing())
         return nullptr;
 
-    if (cls) {
-        Env env;
-        if (env.isSameObject(cls, Globals::classObject)) {
+    switch (kind) {
+        case TargetKind::Object:
             return toAnyObject(value, jpc);
-        }
 
-        switch (value.getType()) {
-            // check compatible primitive types
-            case NT_BOOLEAN: {
-                if (env.isSameObject(cls, Globals::classBoolean)
-                    || env.isSameObject(cls, Globals::classPrimitiveBoolean)) {
-                    return toAnyObject(value, jpc);
-                }
-                break;
+        // check compatible primitive types
+        case TargetKind::Boolean:
+            if (value.getType() == NT_BOOLEAN) {
+                return toAnyObject(value, jpc);
             }
+            break;
 
-            case NT_INT: {
-                if (env.isSameObject(cls, Globals::classInteger)
-                    || env.isSameObject(cls, Globals::classPrimitiveInt)) {
-                    jvalue arg;
-                    int64 v = value.getAsBigInt();
-                    arg.i = (int)v;
-                    return env.newObject(Globals::classInteger, Globals::ctorInteger, &arg).release();
-                }
-                if (env.isSameObject(cls, Globals::classLong) || env.isSameObject(cls, Globals::classPrimitiveLong)) {
-                    jvalue arg;
-                    int64 v = value.getAsBigInt();
-                    arg.j = v;
-                    return env.newObject(Globals::classLong, Globals::ctorLong, &arg).release();
-                }
-                break;
+        case TargetKind::Integer:
+            if (value.getType() == NT_INT) {
+                Env env;
+                return Globals::boxInteger(env, (jint)value.getAsBigInt()).release();
             }
+            break;
 
-            case NT_FLOAT: {
-                if (env.isSameObject(cls, Globals::classDouble)
-                    || env.isSameObject(cls, Globals::classPrimitiveDouble)) {
-                    return toAnyObject(value, jpc);
-                }
-                break;
+        case TargetKind::Long:
+            if (value.getType() == NT_INT) {
+                Env env;
+                return Globals::boxLong(env, value.getAsBigInt()).release();
             }
-        }
+            break;
+
+        case TargetKind::Double:
+            if (value.getType() == NT_FLOAT) {
+                return toAnyObject(value, jpc);
+            }
+            break;
+
+        case TargetKind::String:
+            // no type check is needed for the result
+            if (value.getType() == NT_STRING) {
+                return jni_string_to_jstring(*value.get<QoreStringNode>());
+            }
+            break;
+
+        default:
+            break;
     }
 
     LocalReference<jobject> javaObjectRef;
@@ -202,6 +250,20 @@ jobject QoreToJava::toObject(const QoreValue& value, jclass cls, JniExternalProg
             break;
         }
         case NT_HASH: {
+            if (cls && JniExternalProgramData::lazyHashes()) {
+                // the proxy can be used for any target class that it is assignable to
+                Env env;
+                if (env.isAssignableFrom(Globals::classQoreHashProxy, cls)) {
+                    return makeHashProxy(*value.get<QoreHashNode>(), jpc);
+                }
+            }
+            if (jni_marshal_data && cls) {
+                // hashes converted to the default map class can be marshalled with a single call
+                Env env;
+                if (env.isSameObject(cls, Globals::classHash) || env.isSameObject(cls, Globals::classMap)) {
+                    return DataMarshaller::toJava(env, value, jpc).release();
+                }
+            }
             return makeMap(*value.get<QoreHashNode>(), cls, jpc);
         }
         case NT_OBJECT: {
@@ -244,6 +306,12 @@ jobject QoreToJava::toObject(const QoreValue& value, jclass cls, JniExternalProg
             break;
         }
         case NT_BINARY: {
+            if (cls) {
+                Env env;
+                if (env.isAssignableFrom(Globals::classByteBuffer, cls)) {
+                    return makeDirectByteBuffer(*value.get<BinaryNode>());
+                }
+            }
             return makeByteArray(*value.get<BinaryNode>());
         }
         default: {
@@ -287,48 +355,314 @@ jobject QoreToJava::toObject(const QoreValue& value, jclass cls, JniExternalProg
     return javaObjectRef.release();
 }
 
-jobject QoreToJava::makeMap(const QoreHashNode& h, jclass cls, JniExternalProgramData* jpc) {
-    Env env;
-
-    // get constructor for class
-    jmethodID ctor;
-    jmethodID put;
+QoreToJava::MapTarget QoreToJava::findMapTarget(Env& env, jclass cls) {
+    MapTarget rv;
+    rv.cls = cls;
+    rv.sized_ctor = nullptr;
     try {
-        ctor = env.getMethod(cls, "<init>", "()V");
-        put = env.getMethod(cls, "put", "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
+        rv.ctor = env.getMethod(cls, "<init>", "()V");
+        rv.put = env.getMethod(cls, "put", "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
     } catch (jni::Exception& e) {
         e.ignore();
-        // try Hash
-        cls = Globals::classHash;
-        ctor = Globals::ctorHash;
-        put = Globals::methodHashPut;
+        // use Hash
+        rv.cls = Globals::classHash;
+        rv.ctor = Globals::ctorHash;
+        rv.sized_ctor = Globals::ctorHashSized;
+        rv.put = Globals::methodHashPut;
+        rv.bulk = true;
+        return rv;
     }
+    // the meaning of an int constructor argument is only known for HashMap
+    if (env.isSameObject(cls, Globals::classHashMap)) {
+        rv.sized_ctor = Globals::ctorHashMapSized;
+    }
+    rv.bulk = env.isAssignableFrom(cls, Globals::classMap);
+    return rv;
+}
 
-    LocalReference<jobject> hm = env.newObject(cls, ctor, nullptr);
+QoreToJava::MapTarget QoreToJava::getMapTarget(Env& env, jclass cls) {
+    if (env.isSameObject(cls, Globals::classHash)) {
+        return {Globals::classHash, Globals::ctorHash, Globals::ctorHashSized, Globals::methodHashPut, true};
+    }
 
-    ConstHashIterator i(h);
-    while (i.next()) {
-        LocalReference<jstring> key = env.newString(i.getKey());
-        QoreValue v(i.get());
-        LocalReference<jobject> value = toAnyObject(v, jpc);
+    jvalue jarg;
+    jarg.l = cls;
+    jint hash = env.callStaticIntMethod(Globals::classSystem, Globals::methodSystemIdentityHashCode, &jarg);
 
-        std::vector<jvalue> jargs(2);
-        jargs[0].l = key;
-        jargs[1].l = value;
+    auto make_target = [cls] (const MapTargetEntry& entry) -> MapTarget {
+        if (entry.use_hash) {
+            return {Globals::classHash, Globals::ctorHash, Globals::ctorHashSized, Globals::methodHashPut, true};
+        }
+        return {cls, entry.ctor, entry.sized_ctor, entry.put, entry.bulk};
+    };
+
+    {
+        QoreAutoRWReadLocker al(mt_lock);
+        auto range = mt_map.equal_range(hash);
+        for (auto i = range.first; i != range.second; ++i) {
+            if (env.isSameObject(i->second.cls, cls)) {
+                return make_target(i->second);
+            }
+        }
+    }
+
+    MapTarget rv = findMapTarget(env, cls);
 
-        env.callObjectMethod(hm, put, &jargs[0]);
+    QoreAutoRWWriteLocker al(mt_lock);
+    if (mt_map.size() >= MapTargetCacheMax) {
+        // purge entries for classes that have been unloaded
+        for (mtmap_t::iterator i = mt_map.begin(), e = mt_map.end(); i != e;) {
+            if (env.isSameObject(i->second.cls, nullptr)) {
+                env.deleteWeakGlobalRef(i->second.cls);
+                i = mt_map.erase(i);
+            } else {
+                ++i;
+            }
+        }
+    }
+    if (mt_map.size() < MapTargetCacheMax) {
+        // another thread may have added the class in the meantime; duplicate entries are harmless but wasteful
+        auto range = mt_map.equal_range(hash);
+        for (auto i = range.first; i != range.second; ++i) {
+            if (env.isSameObject(i->second.cls, cls)) {
+                return rv;
+            }
+        }
+        MapTargetEntry entry;
+        entry.cls = env.newWeakGlobalRef(cls);
+        entry.use_hash = !env.isSameObject(rv.cls, cls);
+        entry.ctor = rv.ctor;
+        entry.sized_ctor = rv.sized_ctor;
+        entry.put = rv.put;
+        entry.bulk = rv.bulk;
+        mt_map.insert(mtmap_t::value_type(hash, entry));
+    }
+    return rv;
+}
+
+void QoreToJava::clearMapTargetCache() {
+    Env env;
+    QoreAutoRWWriteLocker al(mt_lock);
+    for (auto& i : mt_map) {
+        env.deleteWeakGlobalRef(i.second.cls);
+    }
+    mt_map.clear();
+}
+
+void QoreToJava::initKeyCache(size_t max_size) {
+    key_cache.reset(new JavaKeyCache(max_size));
+}
+
+void QoreToJava::clearKeyCache() {
+    if (key_cache) {
+        key_cache->clear();
+    }
+}
+
+QoreHashNode* QoreToJava::getKeyCacheStats() {
+    return key_cache ? key_cache->getStats() : nullptr;
+}
+
+jstring QoreToJava::getCachedKey(Env& env, const char* key) {
+    return key_cache ? key_cache->get(env, key) : nullptr;
+}
+
+jstring QoreToJava::getKey(Env& env, const char* key) {
+    jstring rv = getCachedKey(env, key);
+    if (rv) {
+        return rv;
+    }
+    return StringTranscoder::toJava(env, key, strlen(key)).release();
+}
+
+LocalReference<jobject> QoreToJava::getZoneOffset(Env& env, int seconds_east) {
+    {
+        QoreAutoRWReadLocker al(zo_lock);
+        zomap_t::const_iterator i = zo_map.find(seconds_east);
+        if (i != zo_map.end()) {
+            return env.newLocalRef<jobject>(i->second);
+        }
+    }
+
+    jvalue jarg;
+    jarg.i = seconds_east;
+    LocalReference<jobject> offset = env.callStaticObjectMethod(Globals::classZoneOffset,
+        Globals::methodZoneOffsetOfTotalSeconds, &jarg);
+
+    QoreAutoRWWriteLocker al(zo_lock);
+    if (zo_map.find(seconds_east) == zo_map.end()) {
+        zo_map.insert(zomap_t::value_type(seconds_east, offset.makeGlobal()));
+    }
+    return offset;
+}
+
+void QoreToJava::clearZoneOffsetCache() {
+    QoreAutoRWWriteLocker al(zo_lock);
+    zo_map.clear();
+}
+
+jobject QoreToJava::makeMap(const QoreHashNode& h, jclass cls, JniExternalProgramData* jpc) {
+    Env env;
+
+    MapTarget target = getMapTarget(env, cls);
+    size_t size = h.size();
+
+    LocalReference<jobject> hm;
+    if (target.sized_ctor && size <= static_cast<size_t>(std::numeric_limits<jint>::max() / 2)) {
+        // size the map so that it is not rehashed with the default load factor of 0.75
+        jvalue arg;
+        arg.i = static_cast<jint>(size + size / 3 + 1);
+        hm = env.newObject(target.cls, target.sized_ctor, &arg);
+    } else {
+        hm = env.newObject(target.cls, target.ctor, nullptr);
+    }
+
+    if (!size) {
+        return hm.release();
+    }
+
+    if (target.bulk && size <= static_cast<size_t>(std::numeric_limits<jsize>::max() / 2)) {
+        // add all entries with a single call to Java
+        LocalReference<jobjectArray> kv = env.newObjectArray(static_cast<jsize>(size * 2), Globals::classObject);
+        {
+            // the key and value references are left to the frame and freed in bulk when it is recycled
+            Env::LocalFrame frame(env);
+            ConstHashIterator i(h);
+            jsize idx = 0;
+            while (i.next()) {
+                frame.next();
+                env.setObjectArrayElement(kv, idx++, getKey(env, i.getKey()));
+                env.setObjectArrayElement(kv, idx++, toAnyObject(i.get(), jpc));
+            }
+        }
+
+        jvalue jargs[2];
+        jargs[0].l = hm;
+        jargs[1].l = kv;
+        env.callStaticVoidMethod(Globals::classQoreJavaApi, Globals::methodQoreJavaApiPutAll, jargs);
+        return hm.release();
+    }
+
+    {
+        // the key, value, and put() result references are left to the frame and freed in bulk when it is recycled
+        Env::LocalFrame frame(env);
+        ConstHashIterator i(h);
+        while (i.next()) {
+            frame.next();
+            jvalue jargs[2];
+            jargs[0].l = getKey(env, i.getKey());
+            jargs[1].l = toAnyObject(i.get(), jpc);
+
+            env.callObjectMethod(hm, target.put, jargs).release();
+        }
     }
 
     return hm.release();
 }
 
+jobject QoreToJava::makeHashProxy(const QoreHashNode& h, JniExternalProgramData* jpc) {
+    size_t size = h.size();
+    if (size > static_cast<size_t>(std::numeric_limits<jint>::max() / 2)) {
+        return makeMap(h, Globals::classHash, jpc);
+    }
+
+    Env env;
+    QoreHashNode* node = const_cast<QoreHashNode*>(&h);
+    node->ref();
+    jvalue jargs[2];
+    jargs[0].j = reinterpret_cast<jlong>(node);
+    jargs[1].i = static_cast<jint>(size);
+    try {
+        // from now on, the proxy is responsible for the reference
+        return env.newObject(Globals::classQoreHashProxy, Globals::ctorQoreHashProxy, jargs).release();
+    } catch (...) {
+        ExceptionSink xsink;
+        node->deref(&xsink);
+        throw;
+    }
+}
+
+jobjectArray QoreToJava::makeKeyArray(Env& env, const QoreHashNode& h) {
+    LocalReference<jobjectArray> keys = env.newObjectArray(static_cast<jsize>(h.size()), Globals::classString);
+    {
+        // cached keys are not affected by the frame; other key references are freed in bulk when it is recycled
+        Env::LocalFrame frame(env);
+        ConstHashIterator i(h);
+        jsize idx = 0;
+        while (i.next()) {
+            frame.next();
+            env.setObjectArrayElement(keys, idx++, getKey(env, i.getKey()));
+        }
+    }
+    return keys.release();
+}
+
 jbyteArray QoreToJava::makeByteArray(const BinaryNode& b) {
+    if (b.size() > static_cast<size_t>(std::numeric_limits<jsize>::max())) {
+        QoreStringMaker desc("cannot convert a binary value of size " QLLD " to a Java byte array; the maximum size "
+            "is %d", (int64)b.size(), std::numeric_limits<jsize>::max());
+        throw BasicException(desc.c_str());
+    }
+
     Env env;
     LocalReference<jbyteArray> array = env.newByteArray(b.size()).as<jbyteArray>();
-    for (jsize i = 0; i < static_cast<jsize>(b.size()); ++i) {
-        env.setByteArrayElement(array, i, ((const char*)b.getPtr())[i]);
-    }
+    env.setBytes(array, b.getPtr(), b.size());
 
     return array.release();
 }
+
+jobject QoreToJava::makeDirectByteBuffer(const BinaryNode& b) {
+    Env env;
+    if (!b.size()) {
+        return env.newDirectByteBuffer(&empty_buffer, 0).release();
+    }
+
+    void* ptr = const_cast<void*>(b.getPtr());
+    LocalReference<jobject> buf = env.newDirectByteBuffer(ptr, b.size());
+
+    BinaryNode* node = const_cast<BinaryNode*>(&b);
+    node->ref();
+    {
+        AutoLocker al(db_lock);
+        db_map.insert(dbmap_t::value_type(ptr, node));
+    }
+
+    // from now on, the Java QoreBinaryBuffer object is responsible for the reference
+    jvalue jargs[2];
+    jargs[0].l = buf;
+    jargs[1].j = reinterpret_cast<jlong>(node);
+    try {
+        return env.callStaticObjectMethod(Globals::classQoreBinaryBuffer, Globals::methodQoreBinaryBufferRegister,
+            jargs).release();
+    } catch (...) {
+        releaseDirectBinary(node);
+        throw;
+    }
+}
+
+void QoreToJava::releaseDirectBinary(BinaryNode* b) {
+    {
+        AutoLocker al(db_lock);
+        auto range = db_map.equal_range(b->getPtr());
+        for (auto i = range.first; i != range.second; ++i) {
+            if (i->second == b) {
+                db_map.erase(i);
+                break;
+            }
+        }
+    }
+    b->deref();
+}
+
+BinaryNode* QoreToJava::findDirectBinary(const void* ptr, size_t size) {
+    AutoLocker al(db_lock);
+    auto range = db_map.equal_range(ptr);
+    for (auto i = range.first; i != range.second; ++i) {
+        if (i->second->size() == size) {
+            i->second->ref();
+            return i->second;
+        }
+    }
+    return nullptr;
+}
 }
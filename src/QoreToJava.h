@@ -84,14 +84,70 @@ public:
         return static_cast<jshort>(value.getAsBigInt());
     }
 
-    static jobject toObject(const QoreValue& value, jclass cls, JniExternalProgramData* jpc = nullptr);
+    static jobject toObject(const QoreValue& value, jclass cls, JniExternalProgramData* jpc = nullptr) {
+        return toObject(value, cls, Globals::getTargetKind(cls), jpc);
+    }
+
+    //! Converts a value to a Java object of the given class
+    /** @param value the value to convert
+        @param cls the target class; may be nullptr
+        @param kind the classification of \a cls as returned by Globals::getTargetKind(); callers converting many
+        values to the same class can determine it once
+        @param jpc the program context
+    */
+    static jobject toObject(const QoreValue& value, jclass cls, TargetKind kind, JniExternalProgramData* jpc);
 
     static jobject toAnyObject(const QoreValue& value, JniExternalProgramData* jpc = nullptr);
 
     static jobject makeMap(const QoreHashNode& h, jclass cls, JniExternalProgramData* jpc = nullptr);
 
+    //! Returns an org.qore.jni.QoreHashProxy object referencing the hash; values are converted when accessed
+    /** The hash is referenced until the proxy is collected by the JVM or copied on the first modification
+    */
+    static jobject makeHashProxy(const QoreHashNode& h, JniExternalProgramData* jpc = nullptr);
+
+    //! Returns a String[] with the keys of the hash in order
+    static jobjectArray makeKeyArray(Env& env, const QoreHashNode& h);
+
+    //! Clears the cache of map classes used by makeMap()
+    static void clearMapTargetCache();
+
+    //! Enables the hash key cache with the given maximum number of keys
+    static void initKeyCache(size_t max_size);
+
+    //! Deletes all cached hash keys
+    static void clearKeyCache();
+
+    //! Returns hash key cache statistics or nullptr if the cache is not enabled
+    static QoreHashNode* getKeyCacheStats();
+
+    //! Returns the cached Java string for a hash key or nullptr if the key cache is not enabled or cannot hold the key
+    /** The string is owned by the key cache
+    */
+    static jstring getCachedKey(Env& env, const char* key);
+
+    //! Returns a local reference to the java.time.ZoneOffset for the given UTC offset; offsets are cached
+    static LocalReference<jobject> getZoneOffset(Env& env, int seconds_east);
+
+    //! Deletes all cached java.time.ZoneOffset objects
+    static void clearZoneOffsetCache();
+
     static jbyteArray makeByteArray(const BinaryNode& b);
 
+    //! Returns a read-only direct java.nio.ByteBuffer referring to the memory of the binary value
+    /** The binary value is referenced until the buffer is collected by the JVM; the memory is not copied
+    */
+    static jobject makeDirectByteBuffer(const BinaryNode& b);
+
+    //! Releases the reference to a binary value acquired by makeDirectByteBuffer()
+    static void releaseDirectBinary(BinaryNode* b);
+
+    //! Returns a new reference to the binary value exposed as a direct buffer with the given memory, if any
+    /** @return the binary value or nullptr if the memory does not belong to a buffer created by
+        makeDirectByteBuffer()
+    */
+    static BinaryNode* findDirectBinary(const void* ptr, size_t size);
+
     static void wrapException(ExceptionSink& src) {
         Env env;
         wrapException(env, src);
@@ -128,7 +184,30 @@ public:
     }
 
 private:
+    //! How a hash is converted to an instance of a given map class
+    struct MapTarget {
+        //! the class to instantiate; org.qore.jni.Hash if the requested class cannot be used
+        jclass cls;
+        //! the no-arg constructor
+        jmethodID ctor;
+        //! a constructor taking the initial capacity, if known; otherwise nullptr
+        jmethodID sized_ctor;
+        //! the put() method
+        jmethodID put;
+        //! true if the class implements java.util.Map so that all entries can be added with a single call
+        bool bulk;
+    };
+
     QoreToJava() = delete;
+
+    //! Returns the conversion info for the given target class; the result is cached per class
+    static MapTarget getMapTarget(Env& env, jclass cls);
+
+    //! Looks up the conversion info for the given target class
+    static MapTarget findMapTarget(Env& env, jclass cls);
+
+    //! Returns a Java string for a hash key; the string is either a local reference or is owned by the key cache
+    static jstring getKey(Env& env, const char* key);
 };
 
 } // namespace jni
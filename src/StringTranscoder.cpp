@@ -0,0 +1,252 @@
+//--------------------------------------------------------------------*- C++ -*-
+//
+//  Qore Programming Language
+//
+//  Copyright (C) 2016 - 2021 Qore Technologies, s.r.o.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+
+#include "StringTranscoder.h"
+#include "defs.h"
+
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <new>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace jni {
+
+bool StringTranscoder::isPlainAscii(const unsigned char* p, size_t len) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        // the sign bit is set for non-ASCII bytes
+        if (_mm_movemask_epi8(_mm_or_si128(v, _mm_cmpeq_epi8(v, zero)))) {
+            return false;
+        }
+    }
+#endif
+    for (; i < len; ++i) {
+        if (!p[i] || p[i] > 0x7f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t StringTranscoder::utf8ToUtf16(const unsigned char* src, size_t len, jchar* dst) {
+    // the minimum code point for each sequence length, to reject overlong encodings
+    static const uint32_t min_cp[5] = {0, 0, 0x80, 0x800, 0x10000};
+
+    size_t i = 0;
+    size_t o = 0;
+    while (i < len) {
+#if defined(__SSE2__)
+        // widen runs of ASCII characters 16 at a time
+        if (i + 16 <= len) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            if (!_mm_movemask_epi8(v)) {
+                const __m128i zero = _mm_setzero_si128();
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + o), _mm_unpacklo_epi8(v, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + o + 8), _mm_unpackhi_epi8(v, zero));
+                i += 16;
+                o += 16;
+                continue;
+            }
+        }
+#endif
+        unsigned char c = src[i];
+        if (c < 0x80) {
+            dst[o++] = c;
+            ++i;
+            continue;
+        }
+
+        size_t n;
+        uint32_t cp;
+        if ((c & 0xe0) == 0xc0) {
+            n = 2;
+            cp = c & 0x1f;
+        } else if ((c & 0xf0) == 0xe0) {
+            n = 3;
+            cp = c & 0x0f;
+        } else if ((c & 0xf8) == 0xf0) {
+            n = 4;
+            cp = c & 0x07;
+        } else {
+            dst[o++] = 0xfffd;
+            ++i;
+            continue;
+        }
+
+        bool valid = i + n <= len;
+        for (size_t k = 1; valid && k < n; ++k) {
+            unsigned char cc = src[i + k];
+            if ((cc & 0xc0) != 0x80) {
+                valid = false;
+            } else {
+                cp = (cp << 6) | (cc & 0x3f);
+            }
+        }
+        // the modified UTF-8 encoding of NUL is the only overlong sequence accepted
+        if (!valid || (cp < min_cp[n] && !(n == 2 && !cp)) || cp > 0x10ffff) {
+            dst[o++] = 0xfffd;
+            ++i;
+            continue;
+        }
+
+        if (cp >= 0x10000) {
+            cp -= 0x10000;
+            dst[o++] = static_cast<jchar>(0xd800 + (cp >> 10));
+            dst[o++] = static_cast<jchar>(0xdc00 + (cp & 0x3ff));
+        } else {
+            dst[o++] = static_cast<jchar>(cp);
+        }
+        i += n;
+    }
+    return o;
+}
+
+size_t StringTranscoder::utf16ToUtf8(const jchar* src, size_t len, char* dst) {
+    unsigned char* out = reinterpret_cast<unsigned char*>(dst);
+    size_t i = 0;
+    size_t o = 0;
+    while (i < len) {
+#if defined(__SSE2__)
+        // narrow runs of ASCII characters 8 at a time
+        if (i + 8 <= len) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            // all code units are ASCII if no bits above the low 7 are set
+            __m128i hi = _mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xff80)));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(hi, _mm_setzero_si128())) == 0xffff) {
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out + o), _mm_packus_epi16(v, v));
+                i += 8;
+                o += 8;
+                continue;
+            }
+        }
+#endif
+        uint32_t c = src[i++];
+        if (c < 0x80) {
+            out[o++] = static_cast<unsigned char>(c);
+            continue;
+        }
+        if (c < 0x800) {
+            out[o++] = static_cast<unsigned char>(0xc0 | (c >> 6));
+            out[o++] = static_cast<unsigned char>(0x80 | (c & 0x3f));
+            continue;
+        }
+        if (c >= 0xd800 && c <= 0xdfff) {
+            if (c <= 0xdbff && i < len && src[i] >= 0xdc00 && src[i] <= 0xdfff) {
+                uint32_t cp = 0x10000 + ((c - 0xd800) << 10) + (src[i++] - 0xdc00);
+                out[o++] = static_cast<unsigned char>(0xf0 | (cp >> 18));
+                out[o++] = static_cast<unsigned char>(0x80 | ((cp >> 12) & 0x3f));
+                out[o++] = static_cast<unsigned char>(0x80 | ((cp >> 6) & 0x3f));
+                out[o++] = static_cast<unsigned char>(0x80 | (cp & 0x3f));
+                continue;
+            }
+            // unpaired surrogate
+            c = 0xfffd;
+        }
+        out[o++] = static_cast<unsigned char>(0xe0 | (c >> 12));
+        out[o++] = static_cast<unsigned char>(0x80 | ((c >> 6) & 0x3f));
+        out[o++] = static_cast<unsigned char>(0x80 | (c & 0x3f));
+    }
+    return o;
+}
+
+LocalReference<jstring> StringTranscoder::toJava(Env& env, const QoreString& str) {
+    const QoreEncoding* enc = str.getEncoding();
+    if ((enc == QCS_UTF8 || enc->isAsciiCompat())
+        && isPlainAscii(reinterpret_cast<const unsigned char*>(str.c_str()), str.size())) {
+        // modified UTF-8 is identical to ASCII for characters other than NUL
+        return env.newString(str.c_str());
+    }
+
+    ExceptionSink xsink;
+    TempEncodingHelper utf8;
+    utf8.set(&str, QCS_UTF8, &xsink);
+    if (xsink) {
+        throw XsinkException(xsink);
+    }
+
+    return toJava(env, utf8->c_str(), utf8->size());
+}
+
+LocalReference<jstring> StringTranscoder::toJava(Env& env, const char* str, size_t len) {
+    const unsigned char* src = reinterpret_cast<const unsigned char*>(str);
+    if (isPlainAscii(src, len)) {
+        // modified UTF-8 is identical to ASCII for characters other than NUL
+        return env.newString(str);
+    }
+
+    // each byte produces at most one UTF-16 code unit
+    if (len > static_cast<size_t>(std::numeric_limits<jsize>::max())) {
+        QoreStringMaker desc("cannot convert a string of size " QLLD " to a Java string; the maximum size is %d",
+            (int64)len, std::numeric_limits<jsize>::max());
+        throw BasicException(desc.c_str());
+    }
+
+    if (len <= StackChars) {
+        jchar buf[StackChars];
+        size_t n = utf8ToUtf16(src, len, buf);
+        return env.newString(buf, static_cast<jsize>(n));
+    }
+    std::unique_ptr<jchar[]> buf(new jchar[len]);
+    size_t n = utf8ToUtf16(src, len, buf.get());
+    return env.newString(buf.get(), static_cast<jsize>(n));
+}
+
+QoreStringNode* StringTranscoder::toQore(Env& env, jstring str) {
+    size_t len = env.getStringLength(str);
+    if (!len) {
+        return new QoreStringNode("", QCS_UTF8);
+    }
+
+    // the modified UTF-8 length is an upper bound for the UTF-8 length
+    size_t alloc = static_cast<size_t>(env.getStringUtfLength(str)) + 1;
+    std::unique_ptr<char, void (*)(void*)> buf(static_cast<char*>(malloc(alloc)), free);
+    if (!buf) {
+        throw std::bad_alloc();
+    }
+
+    size_t n;
+    if (len <= StackChars) {
+        jchar chars[StackChars];
+        env.getStringRegion(str, 0, static_cast<jsize>(len), chars);
+        n = utf16ToUtf8(chars, len, buf.get());
+    } else {
+        // transcode directly from the Java string without an intermediate copy if the JVM allows it
+        Env::StringCritical chars(env, str);
+        n = utf16ToUtf8(chars.get(), len, buf.get());
+    }
+    assert(n < alloc);
+    buf.get()[n] = '\0';
+
+    return new QoreStringNode(buf.release(), n, alloc, QCS_UTF8);
+}
+
+} // namespace jni
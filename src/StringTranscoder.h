@@ -0,0 +1,103 @@
+//--------------------------------------------------------------------*- C++ -*-
+//
+//  Qore Programming Language
+//
+//  Copyright (C) 2016 - 2021 Qore Technologies, s.r.o.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a
+//  copy of this software and associated documentation files (the "Software"),
+//  to deal in the Software without restriction, including without limitation
+//  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//  and/or sell copies of the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+//  DEALINGS IN THE SOFTWARE.
+//
+//------------------------------------------------------------------------------
+///
+/// \file
+/// \brief Defines the StringTranscoder class.
+///
+//------------------------------------------------------------------------------
+#ifndef QORE_JNI_STRINGTRANSCODER_H_
+#define QORE_JNI_STRINGTRANSCODER_H_
+
+#include <qore/Qore.h>
+#include <jni.h>
+
+#include "LocalReference.h"
+#include "Env.h"
+
+namespace jni {
+
+/**
+ * \brief Converts strings between Qore and Java.
+ *
+ * Strings that consist only of ASCII characters are passed to and from Java without transcoding.  All other
+ * strings are converted between UTF-8 and UTF-16 in a single pass, so that supplementary characters and embedded
+ * NUL characters are converted correctly, which is not the case with JNI's "modified UTF-8" functions.
+ */
+class StringTranscoder {
+public:
+    /**
+     * \brief Converts a Qore string to a Java string.
+     * \param env the JNI environment
+     * \param str the string to convert; strings not in UTF-8 encoding are converted to UTF-8 first
+     * \return the Java string
+     * \throws XsinkException if the string cannot be converted to UTF-8
+     * \throws JavaException if the Java string cannot be created
+     */
+    DLLLOCAL static LocalReference<jstring> toJava(Env& env, const QoreString& str);
+
+    /**
+     * \brief Converts a string in UTF-8 encoding, such as a hash key, to a Java string.
+     * \param env the JNI environment
+     * \param str the string in UTF-8 encoding
+     * \param len the length of the string in bytes
+     * \return the Java string
+     * \throws JavaException if the Java string cannot be created
+     */
+    DLLLOCAL static LocalReference<jstring> toJava(Env& env, const char* str, size_t len);
+
+    /**
+     * \brief Converts a Java string to a Qore string in UTF-8 encoding.
+     * \param env the JNI environment
+     * \param str the string to convert; must not be null
+     * \return the Qore string
+     * \throws JavaException if the string cannot be accessed
+     */
+    DLLLOCAL static QoreStringNode* toQore(Env& env, jstring str);
+
+    //! Returns true if the buffer contains only ASCII characters other than NUL
+    DLLLOCAL static bool isPlainAscii(const unsigned char* p, size_t len);
+
+    //! Converts UTF-8 to UTF-16; \a dst must have space for \a len code units; returns the number of code units
+    /** invalid sequences are replaced with U+FFFD; the two-byte sequence for NUL used by modified UTF-8 is accepted
+    */
+    DLLLOCAL static size_t utf8ToUtf16(const unsigned char* src, size_t len, jchar* dst);
+
+    //! Converts UTF-16 to UTF-8; returns the number of bytes written
+    /** \a dst must have space for the length of the string in modified UTF-8 encoding, which is never less than the
+        length in UTF-8 encoding; unpaired surrogates are replaced with U+FFFD
+    */
+    DLLLOCAL static size_t utf16ToUtf8(const jchar* src, size_t len, char* dst);
+
+private:
+    //! strings up to this number of UTF-16 code units are copied to the stack instead of being accessed directly
+    static constexpr size_t StackChars = 256;
+
+    StringTranscoder() = delete;
+};
+
+} // namespace jni
+
+#endif // QORE_JNI_STRINGTRANSCODER_H_
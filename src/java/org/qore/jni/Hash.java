@@ -23,6 +23,11 @@ public class Hash extends LinkedHashMap<String, Object> {
         super();
     }
 
+    //! Creates the object with the given initial capacity
+    public Hash(int initialCapacity) {
+        super(initialCapacity);
+    }
+
     //! Creates the object
     public Hash(Map<String, Object> m) {
         super(m);
@@ -7,11 +7,28 @@ import java.lang.reflect.Type;
 
 import java.util.Arrays;
 import java.util.ArrayList;
+import java.util.HashMap;
 import java.util.List;
 import java.util.Collections;
 
+import java.io.BufferedInputStream;
+import java.io.BufferedOutputStream;
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
+import java.io.File;
+import java.io.InputStream;
+
+import java.net.URL;
+import java.net.URLClassLoader;
+
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
 import java.nio.file.Files;
 import java.nio.file.Path;
+import java.nio.file.Paths;
+import java.nio.file.StandardCopyOption;
+
+import java.security.MessageDigest;
 
 import net.bytebuddy.ByteBuddy;
 import net.bytebuddy.description.modifier.Ownership;
@@ -48,6 +65,10 @@ public class JavaClassBuilder {
     private static Method mGetConstantValue;
     private static final String CLASS_FIELD = "$qore_cls_ptr";
 
+    // bytecode cache file magic ("QJBC") and format version
+    private static final int BYTE_CODE_CACHE_MAGIC = 0x514a4243;
+    private static final int BYTE_CODE_CACHE_VERSION = 2;
+
     // copied from org.objectweb.asm.Opcodes
     public static final int ACC_PUBLIC    = (1 << 0);
     public static final int ACC_PRIVATE   = (1 << 1);
@@ -485,6 +506,271 @@ public class JavaClassBuilder {
         return false;
     }
 
+    /** Returns a string identifying the environment of a generated class for the persistent bytecode cache
+
+        The string contains the classpath of the given class loader and its parents and a digest of the class file
+        of each class in the hierarchy of the given parent class that was loaded from a class file, so that cached
+        bytecode is not used if the classpath or any parent class changes.  Classes generated in memory have no class
+        file and are identified by the %Qore classes they are generated for.
+
+        @param loader the class loader that will load the generated class
+        @param parent the parent class of the generated class
+
+        @return a string to be included in the cache key
+     */
+    public static String getByteCodeCacheEnvironment(ClassLoader loader, Class<?> parent) throws Throwable {
+        StringBuilder sb = new StringBuilder();
+        for (ClassLoader cl = loader; cl != null; cl = cl.getParent()) {
+            if (cl instanceof URLClassLoader) {
+                for (URL url : ((URLClassLoader)cl).getURLs()) {
+                    sb.append(url.toString());
+                    sb.append(File.pathSeparatorChar);
+                }
+            }
+        }
+        sb.append(System.getProperty("java.class.path"));
+
+        MessageDigest md = MessageDigest.getInstance("SHA-256");
+        for (Class<?> cls = parent; cls != null && cls != Object.class; cls = cls.getSuperclass()) {
+            ClassLoader cl = cls.getClassLoader();
+            if (cl == null) {
+                // JDK classes are covered by the Java version
+                continue;
+            }
+            URL url = cl.getResource(cls.getName().replace('.', '/') + ".class");
+            if (url == null) {
+                continue;
+            }
+            try (InputStream in = url.openStream()) {
+                byte[] buf = new byte[8192];
+                int len;
+                while ((len = in.read(buf)) > 0) {
+                    md.update(buf, 0, len);
+                }
+            }
+        }
+        sb.append('\0');
+        for (byte b : md.digest()) {
+            sb.append(String.format("%02x", b));
+        }
+        return sb.toString();
+    }
+
+    /** Returns cached bytecode for the given key from the given cache directory
+
+        @param dir the cache directory
+        @param key the cache key identifying the Qore class and the module version
+
+        @return null if there is no valid cache entry, otherwise an array of four elements: the relocation
+        descriptors (String[]), the native pointers embedded in the bytecode when it was generated (long[]), the
+        bytecode (byte[]), and the constant pool indexes of the native pointers (int[])
+     */
+    public static Object[] loadCachedByteCode(String dir, byte[] key) {
+        try {
+            Path path = getByteCodeCachePath(dir, key);
+            if (!Files.isRegularFile(path)) {
+                return null;
+            }
+            try (DataInputStream in = new DataInputStream(new BufferedInputStream(Files.newInputStream(path)))) {
+                if (in.readInt() != BYTE_CODE_CACHE_MAGIC || in.readInt() != BYTE_CODE_CACHE_VERSION) {
+                    return null;
+                }
+                byte[] file_key = new byte[in.readInt()];
+                in.readFully(file_key);
+                if (!Arrays.equals(key, file_key)) {
+                    return null;
+                }
+                int count = in.readInt();
+                String[] descs = new String[count];
+                long[] ptrs = new long[count];
+                int[] indexes = new int[count];
+                for (int i = 0; i < count; ++i) {
+                    ptrs[i] = in.readLong();
+                    indexes[i] = in.readInt();
+                    descs[i] = in.readUTF();
+                }
+                byte[] byte_code = new byte[in.readInt()];
+                in.readFully(byte_code);
+                return new Object[]{descs, ptrs, byte_code, indexes};
+            }
+        } catch (Throwable e) {
+            // a missing or corrupt cache entry is treated as a cache miss
+            return null;
+        }
+    }
+
+    /** Stores generated bytecode in the given cache directory
+
+        Errors are ignored, as the cache is only used to avoid regenerating bytecode.  The entry is written to a
+        temporary file first and then moved into place so that concurrent processes never see partial entries.
+
+        The constant pool index of each native pointer is stored with the pointer so that only the entries emitted
+        for native pointers are patched when the bytecode is relocated.
+
+        @param dir the cache directory
+        @param key the cache key identifying the Qore class and the module version
+        @param descs the relocation descriptors for the native pointers embedded in the bytecode
+        @param ptrs the native pointers embedded in the bytecode
+        @param byteCode the generated bytecode
+     */
+    public static void storeCachedByteCode(String dir, byte[] key, String[] descs, long[] ptrs, byte[] byteCode) {
+        Path tmp = null;
+        try {
+            int[] indexes = getPointerIndexes(byteCode, ptrs);
+            Path path = getByteCodeCachePath(dir, key);
+            Files.createDirectories(path.getParent());
+            tmp = Files.createTempFile(path.getParent(), ".qjbc", ".tmp");
+            try (DataOutputStream out = new DataOutputStream(new BufferedOutputStream(Files.newOutputStream(tmp)))) {
+                out.writeInt(BYTE_CODE_CACHE_MAGIC);
+                out.writeInt(BYTE_CODE_CACHE_VERSION);
+                out.writeInt(key.length);
+                out.write(key);
+                out.writeInt(ptrs.length);
+                for (int i = 0; i < ptrs.length; ++i) {
+                    out.writeLong(ptrs[i]);
+                    out.writeInt(indexes[i]);
+                    out.writeUTF(descs[i]);
+                }
+                out.writeInt(byteCode.length);
+                out.write(byteCode);
+            }
+            Files.move(tmp, path, StandardCopyOption.REPLACE_EXISTING, StandardCopyOption.ATOMIC_MOVE);
+            tmp = null;
+        } catch (Throwable e) {
+            // ignore errors; the bytecode will be generated again next time
+        } finally {
+            if (tmp != null) {
+                try {
+                    Files.deleteIfExists(tmp);
+                } catch (Throwable e) {
+                }
+            }
+        }
+    }
+
+    /** Returns a copy of the given bytecode with native pointers replaced in the constant pool
+
+        All native pointers are embedded in generated bytecode as long constants, so relocating the bytecode to the
+        current process only requires patching the \c CONSTANT_Long entries recorded when the bytecode was stored;
+        other long constants are never modified.
+
+        The same pointer is normally recorded several times (ex: the Program for each static method), and all such
+        records refer to the same constant pool entry; records for an entry that has already been patched are
+        accepted if they have the same new value.
+
+        @param byteCode the cached bytecode
+        @param indexes the constant pool indexes of the native pointers; 0 for pointers not embedded in the bytecode
+        @param oldPtrs the native pointers embedded in the bytecode when it was generated
+        @param newPtrs the corresponding native pointers in the current process
+
+        @return the relocated bytecode
+
+        @throw IllegalArgumentException if the bytecode is invalid, does not match the recorded indexes, or if
+        records for the same constant pool entry have different new values
+     */
+    public static byte[] relocateByteCode(byte[] byteCode, int[] indexes, long[] oldPtrs, long[] newPtrs) {
+        byte[] rv = byteCode.clone();
+        ByteBuffer buf = ByteBuffer.wrap(rv);
+        int[] offsets = getConstantPoolOffsets(buf);
+        // maps patched constant pool indexes to their old and new values
+        HashMap<Integer, long[]> patched = new HashMap<Integer, long[]>();
+        for (int i = 0; i < indexes.length; ++i) {
+            int idx = indexes[i];
+            if (idx == 0) {
+                continue;
+            }
+            long[] p = patched.get(idx);
+            if (p != null) {
+                if (p[0] != oldPtrs[i] || p[1] != newPtrs[i]) {
+                    throw new IllegalArgumentException("conflicting relocations for constant pool index " + idx
+                        + " in cached bytecode");
+                }
+                continue;
+            }
+            if (idx >= offsets.length || offsets[idx] == 0 || rv[offsets[idx] - 1] != 5
+                || buf.getLong(offsets[idx]) != oldPtrs[i]) {
+                throw new IllegalArgumentException("invalid constant pool index " + idx + " in cached bytecode");
+            }
+            buf.putLong(offsets[idx], newPtrs[i]);
+            patched.put(idx, new long[]{oldPtrs[i], newPtrs[i]});
+        }
+        return rv;
+    }
+
+    //! Returns the constant pool index of the \c CONSTANT_Long entry for each pointer or 0 if there is none
+    private static int[] getPointerIndexes(byte[] byteCode, long[] ptrs) {
+        ByteBuffer buf = ByteBuffer.wrap(byteCode);
+        int[] offsets = getConstantPoolOffsets(buf);
+        HashMap<Long, Integer> map = new HashMap<Long, Integer>();
+        for (int i = 1; i < offsets.length; ++i) {
+            if (offsets[i] != 0 && byteCode[offsets[i] - 1] == 5) {
+                map.putIfAbsent(buf.getLong(offsets[i]), i);
+            }
+        }
+        int[] rv = new int[ptrs.length];
+        for (int i = 0; i < ptrs.length; ++i) {
+            Integer idx = map.get(ptrs[i]);
+            rv[i] = idx == null ? 0 : idx;
+        }
+        return rv;
+    }
+
+    //! Returns the offset of the data of each constant pool entry after its tag; 0 for unused indexes
+    private static int[] getConstantPoolOffsets(ByteBuffer buf) {
+        if (buf.getInt(0) != 0xcafebabe) {
+            throw new IllegalArgumentException("invalid class file magic in cached bytecode");
+        }
+        // skip magic, minor and major version
+        buf.position(8);
+        int count = buf.getShort() & 0xffff;
+        int[] rv = new int[count];
+        for (int i = 1; i < count; ++i) {
+            int tag = buf.get() & 0xff;
+            rv[i] = buf.position();
+            switch (tag) {
+                // CONSTANT_Utf8
+                case 1:
+                    buf.position(buf.position() + 2 + (buf.getShort(buf.position()) & 0xffff));
+                    break;
+                // CONSTANT_Long, CONSTANT_Double; these take two constant pool entries
+                case 5: case 6:
+                    buf.position(buf.position() + 8);
+                    ++i;
+                    break;
+                // CONSTANT_Class, CONSTANT_String, CONSTANT_MethodType, CONSTANT_Module, CONSTANT_Package
+                case 7: case 8: case 16: case 19: case 20:
+                    buf.position(buf.position() + 2);
+                    break;
+                // CONSTANT_MethodHandle
+                case 15:
+                    buf.position(buf.position() + 3);
+                    break;
+                // CONSTANT_Integer, CONSTANT_Float, CONSTANT_Fieldref, CONSTANT_Methodref,
+                // CONSTANT_InterfaceMethodref, CONSTANT_NameAndType, CONSTANT_Dynamic, CONSTANT_InvokeDynamic
+                case 3: case 4: case 9: case 10: case 11: case 12: case 17: case 18:
+                    buf.position(buf.position() + 4);
+                    break;
+                default:
+                    throw new IllegalArgumentException("invalid constant pool tag " + tag + " in cached bytecode");
+            }
+        }
+        return rv;
+    }
+
+    //! Returns the path of the cache file for the given key
+    private static Path getByteCodeCachePath(String dir, byte[] key) throws Throwable {
+        MessageDigest md = MessageDigest.getInstance("SHA-256");
+        md.update(key);
+        // the class file version generated depends on the JVM
+        md.update(System.getProperty("java.version").getBytes(StandardCharsets.UTF_8));
+        StringBuilder sb = new StringBuilder();
+        for (byte b : md.digest()) {
+            sb.append(String.format("%02x", b));
+        }
+        sb.append(".qjbc");
+        return Paths.get(dir, sb.toString());
+    }
+
     static private Visibility getVisibility(int visibility) {
         switch (visibility) {
             case ACC_PUBLIC:
@@ -0,0 +1,88 @@
+package org.qore.jni;
+
+import java.lang.ref.PhantomReference;
+import java.lang.ref.ReferenceQueue;
+import java.nio.ByteBuffer;
+import java.util.Set;
+import java.util.concurrent.ConcurrentHashMap;
+
+//! Manages the lifetime of direct ByteBuffer objects referring to the memory of %Qore binary values
+/** A %Qore binary value is referenced as long as any ByteBuffer created for it is reachable; the reference is
+    released by a daemon thread after the buffer has been collected.
+
+    Buffers are always read-only, as %Qore binary values can be shared.
+ */
+public final class QoreBinaryBuffer extends PhantomReference<ByteBuffer> {
+    //! queue of collected buffers
+    private static final ReferenceQueue<ByteBuffer> queue = new ReferenceQueue<ByteBuffer>();
+    //! keeps the references reachable until they are processed
+    private static final Set<QoreBinaryBuffer> refs = ConcurrentHashMap.newKeySet();
+    //! the thread that releases binary values when their buffers are collected
+    private static Thread cleaner;
+    //! set when the jni module is unloaded; binary values can no longer be released after this
+    private static volatile boolean stopped;
+
+    //! the pointer to the %Qore binary value
+    private long ptr;
+
+    private QoreBinaryBuffer(ByteBuffer buf, long ptr) {
+        super(buf, queue);
+        this.ptr = ptr;
+    }
+
+    //! Registers a direct buffer created for a %Qore binary value and returns a read-only view of it
+    /** @param buf the direct buffer referring to the memory of the binary value
+        @param ptr the pointer to the binary value; the reference is released when \a buf is collected
+
+        @return a read-only view of \a buf
+     */
+    static ByteBuffer register(ByteBuffer buf, long ptr) {
+        refs.add(new QoreBinaryBuffer(buf, ptr));
+        startCleaner();
+        return buf.asReadOnlyBuffer();
+    }
+
+    //! Stops the thread that releases binary values; called when the jni module is unloaded
+    /** Binary values whose buffers are collected after this call are not released
+     */
+    static synchronized void stopCleaner() throws InterruptedException {
+        stopped = true;
+        if (cleaner != null) {
+            cleaner.interrupt();
+            // wait for a release in progress to finish; the wait is bounded in case the thread is blocked
+            // attaching to Qore while the module is being unloaded
+            cleaner.join(1000);
+            cleaner = null;
+        }
+    }
+
+    private static synchronized void startCleaner() {
+        if (cleaner == null && !stopped) {
+            cleaner = new Thread(QoreBinaryBuffer::processQueue, "QoreBinaryBuffer cleaner");
+            cleaner.setDaemon(true);
+            cleaner.start();
+        }
+    }
+
+    private static void processQueue() {
+        while (!stopped) {
+            try {
+                QoreBinaryBuffer ref = (QoreBinaryBuffer)queue.remove();
+                refs.remove(ref);
+                ref.release();
+            } catch (InterruptedException e) {
+                // the thread is interrupted when it is stopped
+            }
+        }
+    }
+
+    private void release() {
+        long x = ptr;
+        ptr = 0;
+        if (x != 0) {
+            release0(x);
+        }
+    }
+
+    private static native void release0(long ptr);
+}
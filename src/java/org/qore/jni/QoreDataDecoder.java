@@ -0,0 +1,182 @@
+package org.qore.jni;
+
+import java.lang.reflect.Array;
+import java.math.BigDecimal;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+import java.time.Instant;
+import java.time.ZoneOffset;
+import java.time.ZonedDateTime;
+import java.util.ArrayList;
+
+//! Decodes %Qore data structures marshalled by the jni module in a single native buffer
+/** The buffer is written in native byte order; each value starts with a one-byte tag:
+    - \c T_NULL: \c null
+    - \c T_TRUE, \c T_FALSE: \c Boolean
+    - \c T_INT: a \c long value; \c Long
+    - \c T_FLOAT: a \c double value; \c Double
+    - \c T_STRING: an \c int length and UTF-8 bytes; \c String
+    - \c T_BINARY: an \c int length and the bytes; \c byte[]
+    - \c T_DATE: a \c long epoch second, an \c int microsecond, and an \c int UTC offset in seconds;
+      \c ZonedDateTime
+    - \c T_NUMBER: a \c long unscaled value and an \c int scale; \c BigDecimal
+    - \c T_HASH: an \c int count followed by the keys and values; @ref org.qore.jni.Hash
+    - \c T_LIST: an \c int count, the element class, and the values; empty lists are decoded as \c null
+    - \c T_OBJECT: an \c int index in the array of values that were converted individually
+
+    Hash keys are an \c int; a value greater than or equal to 0 is the index of a key already decoded in the same
+    buffer, -1 is followed by an \c int index of a cached key in the object array, and a value <tt>-(len + 2)</tt>
+    is followed by \c len UTF-8 bytes of a new key.
+
+    The element class of a list is a one-byte tag determined by the jni module with the same rules as for lists
+    converted without marshalling; \c E_CLASS is followed by an \c int index of the class in the object array.
+ */
+public final class QoreDataDecoder {
+    static final byte T_NULL = 0;
+    static final byte T_TRUE = 1;
+    static final byte T_FALSE = 2;
+    static final byte T_INT = 3;
+    static final byte T_FLOAT = 4;
+    static final byte T_STRING = 5;
+    static final byte T_BINARY = 6;
+    static final byte T_DATE = 7;
+    static final byte T_NUMBER = 8;
+    static final byte T_HASH = 9;
+    static final byte T_LIST = 10;
+    static final byte T_OBJECT = 11;
+
+    static final byte E_OBJECT = 0;
+    static final byte E_LONG = 1;
+    static final byte E_DOUBLE = 2;
+    static final byte E_BOOLEAN = 3;
+    static final byte E_STRING = 4;
+    static final byte E_NUMBER = 5;
+    static final byte E_HASH = 6;
+    static final byte E_CLASS = 7;
+
+    private final ByteBuffer buf;
+    private final Object[] objects;
+    private final ArrayList<String> keys = new ArrayList<String>();
+    private byte[] scratch = new byte[256];
+
+    private QoreDataDecoder(ByteBuffer buf, Object[] objects) {
+        this.buf = buf.order(ByteOrder.nativeOrder());
+        this.objects = objects;
+    }
+
+    //! Decodes a single value from the given buffer
+    /** @param buf the buffer containing the encoded value
+        @param objects values converted individually and referenced with \c T_OBJECT, cached keys, and list
+        element classes; may be \c null
+
+        @return the decoded value
+     */
+    static Object decode(ByteBuffer buf, Object[] objects) {
+        return new QoreDataDecoder(buf, objects).decodeValue();
+    }
+
+    private Object decodeValue() {
+        byte tag = buf.get();
+        switch (tag) {
+            case T_NULL:
+                return null;
+            case T_TRUE:
+                return Boolean.TRUE;
+            case T_FALSE:
+                return Boolean.FALSE;
+            case T_INT:
+                return Long.valueOf(buf.getLong());
+            case T_FLOAT:
+                return Double.valueOf(buf.getDouble());
+            case T_STRING:
+                return decodeString(buf.getInt());
+            case T_BINARY: {
+                byte[] b = new byte[buf.getInt()];
+                buf.get(b);
+                return b;
+            }
+            case T_DATE: {
+                long secs = buf.getLong();
+                int us = buf.getInt();
+                int offset = buf.getInt();
+                return ZonedDateTime.ofInstant(Instant.ofEpochSecond(secs, us * 1000L),
+                    ZoneOffset.ofTotalSeconds(offset));
+            }
+            case T_NUMBER: {
+                long unscaled = buf.getLong();
+                return BigDecimal.valueOf(unscaled, buf.getInt());
+            }
+            case T_HASH:
+                return decodeHash(buf.getInt());
+            case T_LIST:
+                return decodeList(buf.getInt());
+            case T_OBJECT:
+                return objects[buf.getInt()];
+            default:
+                throw new IllegalStateException(String.format("invalid tag %d at offset %d", tag,
+                    buf.position() - 1));
+        }
+    }
+
+    private String decodeString(int len) {
+        if (len > scratch.length) {
+            scratch = new byte[Math.max(len, scratch.length * 2)];
+        }
+        buf.get(scratch, 0, len);
+        return new String(scratch, 0, len, StandardCharsets.UTF_8);
+    }
+
+    private Hash decodeHash(int size) {
+        Hash h = new Hash(size + size / 3 + 1);
+        for (int i = 0; i < size; ++i) {
+            int k = buf.getInt();
+            String key;
+            if (k >= 0) {
+                key = keys.get(k);
+            } else {
+                key = k == -1 ? (String)objects[buf.getInt()] : decodeString(-(k + 2));
+                keys.add(key);
+            }
+            h.put(key, decodeValue());
+        }
+        return h;
+    }
+
+    private Object decodeList(int size) {
+        if (size == 0) {
+            return null;
+        }
+
+        Object[] values = (Object[])Array.newInstance(decodeElementClass(), size);
+        for (int i = 0; i < size; ++i) {
+            values[i] = decodeValue();
+        }
+        return values;
+    }
+
+    private Class<?> decodeElementClass() {
+        byte ec = buf.get();
+        switch (ec) {
+            case E_OBJECT:
+                return Object.class;
+            case E_LONG:
+                return Long.class;
+            case E_DOUBLE:
+                return Double.class;
+            case E_BOOLEAN:
+                return Boolean.class;
+            case E_STRING:
+                return String.class;
+            case E_NUMBER:
+                return BigDecimal.class;
+            case E_HASH:
+                return Hash.class;
+            case E_CLASS:
+                return (Class<?>)objects[buf.getInt()];
+            default:
+                throw new IllegalStateException(String.format("invalid element class %d at offset %d", ec,
+                    buf.position() - 1));
+        }
+    }
+}
@@ -0,0 +1,328 @@
+package org.qore.jni;
+
+import java.lang.ref.PhantomReference;
+import java.lang.ref.Reference;
+import java.lang.ref.ReferenceQueue;
+import java.util.Collection;
+import java.util.HashMap;
+import java.util.Map;
+import java.util.Set;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.function.BiConsumer;
+import java.util.function.BiFunction;
+import java.util.function.Function;
+
+//! A Hash backed by a %Qore hash whose values are converted to Java only when they are accessed
+/** Objects of this class are created by the jni module for %Qore hashes passed to Java when the \c "lazy-hashes"
+    module option is set.  The %Qore hash is referenced and values are converted when they are retrieved with
+    \c get() and related methods; converted values are cached.
+
+    The %Qore hash is copied into this object on the first modification or when all entries are accessed with
+    \c keySet(), \c values(), \c entrySet(), \c forEach(), or \c containsValue(); after this, the object behaves like
+    a normal @ref org.qore.jni.Hash and the %Qore hash is released.  If the object is passed back to %Qore before it
+    has been copied, the original %Qore hash is used unless a value that was retrieved may have been modified in
+    Java (i.e. a map, collection, or array other than an unmodified proxy); in this case the object is converted
+    like any other map.
+
+    Like @ref org.qore.jni.Hash, this class is not thread-safe.
+ */
+public final class QoreHashProxy extends Hash {
+    //! queue of collected proxies
+    private static final ReferenceQueue<QoreHashProxy> queue = new ReferenceQueue<QoreHashProxy>();
+    //! maps the references of proxies not yet copied to their %Qore hash pointers
+    private static final Map<Reference<QoreHashProxy>, Long> refs =
+        new ConcurrentHashMap<Reference<QoreHashProxy>, Long>();
+    //! the thread that releases %Qore hashes when their proxies are collected
+    private static Thread cleaner;
+    //! set when the jni module is unloaded; no more hashes are released by the cleaner thread
+    private static volatile boolean stopped;
+
+    //! the pointer to the %Qore hash; 0 once the hash has been copied
+    private long ptr;
+    //! the reference registered for this object; null once the hash has been copied
+    private PhantomReference<QoreHashProxy> ref;
+    //! the number of entries in the %Qore hash
+    private final int qsize;
+    //! converted values
+    private HashMap<String, Object> values;
+
+    //! Creates the object for a referenced %Qore hash
+    /** @param ptr the pointer to the %Qore hash; the reference is released when the object is collected or the
+        hash is copied
+        @param size the number of entries in the %Qore hash
+     */
+    QoreHashProxy(long ptr, int size) {
+        super(size + size / 3 + 1);
+        this.ptr = ptr;
+        qsize = size;
+        ref = new PhantomReference<QoreHashProxy>(this, queue);
+        refs.put(ref, ptr);
+        startCleaner();
+    }
+
+    //! Returns the pointer to the %Qore hash or 0 if the hash has been copied or retrieved values may be modified
+    long getHashPtr() {
+        if (ptr == 0) {
+            return 0;
+        }
+        if (values != null) {
+            for (Object v : values.values()) {
+                if (isMutable(v)) {
+                    return 0;
+                }
+            }
+        }
+        return ptr;
+    }
+
+    //! Returns true if the given converted value is a container that may have been modified in Java
+    private static boolean isMutable(Object v) {
+        if (v instanceof QoreHashProxy) {
+            return ((QoreHashProxy)v).getHashPtr() == 0;
+        }
+        return v instanceof Map || v instanceof Collection || (v != null && v.getClass().isArray());
+    }
+
+    @Override
+    public int size() {
+        return ptr != 0 ? qsize : super.size();
+    }
+
+    @Override
+    public boolean isEmpty() {
+        return size() == 0;
+    }
+
+    @Override
+    public boolean containsKey(Object key) {
+        if (ptr == 0) {
+            return super.containsKey(key);
+        }
+        return key instanceof String && containsKey0(ptr, (String)key);
+    }
+
+    @Override
+    public Object get(Object key) {
+        if (ptr == 0) {
+            return super.get(key);
+        }
+        return key instanceof String ? getValue((String)key) : null;
+    }
+
+    @Override
+    public Object getOrDefault(Object key, Object defaultValue) {
+        if (ptr == 0) {
+            return super.getOrDefault(key, defaultValue);
+        }
+        Object v = get(key);
+        return (v != null || containsKey(key)) ? v : defaultValue;
+    }
+
+    @Override
+    public boolean containsValue(Object value) {
+        copy();
+        return super.containsValue(value);
+    }
+
+    @Override
+    public Set<String> keySet() {
+        copy();
+        return super.keySet();
+    }
+
+    @Override
+    public Collection<Object> values() {
+        copy();
+        return super.values();
+    }
+
+    @Override
+    public Set<Map.Entry<String, Object>> entrySet() {
+        copy();
+        return super.entrySet();
+    }
+
+    @Override
+    public void forEach(BiConsumer<? super String, ? super Object> action) {
+        copy();
+        super.forEach(action);
+    }
+
+    @Override
+    public Object put(String key, Object value) {
+        copy();
+        return super.put(key, value);
+    }
+
+    @Override
+    public void putAll(Map<? extends String, ? extends Object> m) {
+        copy();
+        super.putAll(m);
+    }
+
+    @Override
+    public Object remove(Object key) {
+        copy();
+        return super.remove(key);
+    }
+
+    @Override
+    public boolean remove(Object key, Object value) {
+        copy();
+        return super.remove(key, value);
+    }
+
+    @Override
+    public void clear() {
+        release();
+        super.clear();
+    }
+
+    @Override
+    public Object putIfAbsent(String key, Object value) {
+        copy();
+        return super.putIfAbsent(key, value);
+    }
+
+    @Override
+    public boolean replace(String key, Object oldValue, Object newValue) {
+        copy();
+        return super.replace(key, oldValue, newValue);
+    }
+
+    @Override
+    public Object replace(String key, Object value) {
+        copy();
+        return super.replace(key, value);
+    }
+
+    @Override
+    public void replaceAll(BiFunction<? super String, ? super Object, ? extends Object> function) {
+        copy();
+        super.replaceAll(function);
+    }
+
+    @Override
+    public Object computeIfAbsent(String key, Function<? super String, ? extends Object> mappingFunction) {
+        copy();
+        return super.computeIfAbsent(key, mappingFunction);
+    }
+
+    @Override
+    public Object computeIfPresent(String key,
+            BiFunction<? super String, ? super Object, ? extends Object> remappingFunction) {
+        copy();
+        return super.computeIfPresent(key, remappingFunction);
+    }
+
+    @Override
+    public Object compute(String key, BiFunction<? super String, ? super Object, ? extends Object> remappingFunction) {
+        copy();
+        return super.compute(key, remappingFunction);
+    }
+
+    @Override
+    public Object merge(String key, Object value,
+            BiFunction<? super Object, ? super Object, ? extends Object> remappingFunction) {
+        copy();
+        return super.merge(key, value, remappingFunction);
+    }
+
+    @Override
+    public Object clone() {
+        copy();
+        return super.clone();
+    }
+
+    //! Serializes the object as a normal Hash
+    private Object writeReplace() {
+        copy();
+        return new Hash(this);
+    }
+
+    //! Returns the value for the given key, converting it on the first access
+    private Object getValue(String key) {
+        if (values == null) {
+            values = new HashMap<String, Object>();
+        }
+        Object v = values.get(key);
+        if (v == null && !values.containsKey(key)) {
+            v = get0(ptr, key);
+            values.put(key, v);
+        }
+        return v;
+    }
+
+    //! Copies all entries of the %Qore hash into this object in order and releases the %Qore hash
+    private void copy() {
+        if (ptr == 0) {
+            return;
+        }
+        String[] keys = keys0(ptr);
+        for (String key : keys) {
+            super.put(key, getValue(key));
+        }
+        release();
+    }
+
+    //! Releases the %Qore hash without copying it
+    private void release() {
+        long x = ptr;
+        if (x == 0) {
+            return;
+        }
+        ptr = 0;
+        values = null;
+        refs.remove(ref);
+        ref.clear();
+        ref = null;
+        release0(x);
+    }
+
+    //! Stops the thread that releases %Qore hashes; called when the jni module is unloaded
+    /** %Qore hashes whose proxies are collected after this call are not released
+     */
+    static synchronized void stopCleaner() throws InterruptedException {
+        stopped = true;
+        if (cleaner != null) {
+            cleaner.interrupt();
+            // wait for a release in progress to finish; the wait is bounded in case the thread is blocked
+            // attaching to Qore while the module is being unloaded
+            cleaner.join(1000);
+            cleaner = null;
+        }
+    }
+
+    private static synchronized void startCleaner() {
+        if (cleaner == null && !stopped) {
+            cleaner = new Thread(QoreHashProxy::processQueue, "QoreHashProxy cleaner");
+            cleaner.setDaemon(true);
+            cleaner.start();
+        }
+    }
+
+    private static void processQueue() {
+        while (!stopped) {
+            try {
+                Long x = refs.remove(queue.remove());
+                if (x != null) {
+                    release0(x);
+                }
+            } catch (InterruptedException e) {
+                // the thread is interrupted when it is stopped
+            }
+        }
+    }
+
+    //! Returns the converted value for the given key or null if the key does not exist
+    private native Object get0(long ptr, String key);
+
+    //! Returns true if the %Qore hash has the given key
+    private native boolean containsKey0(long ptr, String key);
+
+    //! Returns the keys of the %Qore hash in order
+    private native String[] keys0(long ptr);
+
+    //! Releases the reference to the %Qore hash
+    private static native void release0(long ptr);
+}
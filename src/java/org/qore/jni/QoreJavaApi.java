@@ -2,7 +2,10 @@ package org.qore.jni;
 
 import org.qore.jni.QoreURLClassLoader;
 
+import java.math.BigDecimal;
+import java.math.BigInteger;
 import java.util.Arrays;
+import java.util.Map;
 
 //! This class provides methods that allow Java to interface with Qore code
 /**
@@ -200,6 +203,71 @@ public class QoreJavaApi {
         return stack.length > 0 ? Arrays.copyOfRange(stack, 1, stack.length) : null;
     }
 
+    //! Returns the entries of the given map as a flat array of interleaved keys and values
+    /** Used to convert maps to %Qore hashes with a single JNI call instead of several calls per entry
+
+        @param map the map to flatten
+
+        @return an array of the form <tt>{key0, value0, key1, value1, ...}</tt> or \c null if the map has any key
+        that is \c null or not a \c String and therefore cannot be converted to a %Qore hash
+     */
+    public static Object[] flattenMap(Map<?, ?> map) {
+        Object[] rv = new Object[map.size() * 2];
+        int i = 0;
+        for (Map.Entry<?, ?> entry : map.entrySet()) {
+            Object key = entry.getKey();
+            if (!(key instanceof String)) {
+                return null;
+            }
+            // the map may be modified concurrently
+            if (i == rv.length) {
+                rv = Arrays.copyOf(rv, rv.length * 2 + 2);
+            }
+            rv[i++] = key;
+            rv[i++] = entry.getValue();
+        }
+        return i == rv.length ? rv : Arrays.copyOf(rv, i);
+    }
+
+    //! Adds all keys and values from an array to a map
+    /** This method is used when converting %Qore hashes to Java maps to add all entries to the map with a single
+        call from native code
+
+        @param map the map to add the entries to
+        @param kv an array of the form <tt>{key0, value0, key1, value1, ...}</tt>
+     */
+    @SuppressWarnings("unchecked")
+    public static void putAll(Map<?, ?> map, Object[] kv) {
+        Map<Object, Object> m = (Map<Object, Object>)map;
+        for (int i = 0; i < kv.length; i += 2) {
+            m.put(kv[i], kv[i + 1]);
+        }
+    }
+
+    //! Returns the unscaled value of a BigDecimal if it fits in a long
+    /** This method is used when converting \c BigDecimal values to %Qore numbers
+
+        @param d the value
+
+        @return the unscaled value or \c Long.MIN_VALUE if the unscaled value does not fit in a long, in which case
+        getUnscaledBytes() must be used
+     */
+    public static long getUnscaledLong(BigDecimal d) {
+        BigInteger u = d.unscaledValue();
+        return u.bitLength() < 64 ? u.longValue() : Long.MIN_VALUE;
+    }
+
+    //! Returns the unscaled value of a BigDecimal as a big-endian two's complement byte array
+    /** This method is used when converting \c BigDecimal values to %Qore numbers
+
+        @param d the value
+
+        @return the unscaled value as a big-endian two's complement byte array
+     */
+    public static byte[] getUnscaledBytes(BigDecimal d) {
+        return d.unscaledValue().toByteArray();
+    }
+
     private native static long initQore0();
     private native static Object callFunction0(long pgm_ptr, String name, Object... args);
     private native static Object callFunctionSave0(long pgm_ptr, String name, Object... args);
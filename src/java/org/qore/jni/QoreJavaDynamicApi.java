@@ -22,16 +22,22 @@
 
 package org.qore.jni;
 
+import java.lang.annotation.Annotation;
 import java.lang.reflect.InvocationTargetException;
 import java.lang.reflect.Method;
 import java.lang.invoke.MethodHandle;
 import java.lang.invoke.MethodHandles;
+import java.lang.invoke.MethodType;
 import java.lang.reflect.Field;
 
 //! This class provides methods that allow Java to interface with Qore code
 /**
  */
 public class QoreJavaDynamicApi {
+    //! the type of method handles returned by getSpecialHandle()
+    private static final MethodType SpecialHandleType = MethodType.methodType(Object.class, Object.class,
+        Object[].class);
+
     //! invokes the given method on the given object and returns the return value
     public static Object invokeMethod(Method m, Object obj, Object... args) throws Throwable {
         try {
@@ -46,12 +52,41 @@ public class QoreJavaDynamicApi {
         }
     }
 
-    //! invokes the given method on the given object and returns the return value
-    public static Object invokeMethodNonvirtual(Method m, Object obj, Object... args) throws Throwable {
+    //! returns a method handle for non-virtual calls of the given method
+    /** the handle can be cached and used for any number of calls with invokeSpecial()
+    */
+    public static MethodHandle getSpecialHandle(Method m) throws Throwable {
         Class<?> c = m.getDeclaringClass();
         m.trySetAccessible();
         // works for all cases but generates a warning on the console if used with system classes
-        return MethodHandles.privateLookupIn(c, MethodHandles.lookup()).unreflectSpecial(m, c).bindTo(obj).invokeWithArguments(args);
+        MethodHandle mh = MethodHandles.privateLookupIn(c, MethodHandles.lookup()).unreflectSpecial(m, c);
+        return mh.asFixedArity().asSpreader(Object[].class, m.getParameterCount()).asType(SpecialHandleType);
+    }
+
+    //! invokes a method handle returned by getSpecialHandle() on the given object and returns the return value
+    public static Object invokeSpecial(MethodHandle mh, Object obj, Object[] args) throws Throwable {
+        return (Object)mh.invokeExact(obj, args);
+    }
+
+    //! returns true if the given method is caller-sensitive
+    /** caller-sensitive methods must be called from Java code (and not directly with JNI), so that they are executed
+        with the program's context
+
+        @return true if the given method is caller-sensitive or if its annotations cannot be read
+    */
+    public static boolean isCallerSensitive(Method m) {
+        try {
+            for (Annotation a : m.getDeclaredAnnotations()) {
+                String name = a.annotationType().getName();
+                if (name.equals("jdk.internal.reflect.CallerSensitive")
+                    || name.equals("sun.reflect.CallerSensitive")) {
+                    return true;
+                }
+            }
+            return false;
+        } catch (Throwable e) {
+            return true;
+        }
     }
 
     //! invokes the given method on the given object and returns the return value
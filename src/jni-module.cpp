@@ -36,6 +36,7 @@
 #include <unistd.h>
 #include <errno.h>
 #include <string.h>
+#include <stdlib.h>
 #include <map>
 #include <vector>
 
@@ -85,6 +86,27 @@ DLLEXPORT char qore_module_license_str[] = "MIT";
 // global type compatibility option
 DLLLOCAL bool jni_compat_types = false;
 
+// global lazy collection conversion option
+DLLLOCAL bool jni_lazy_collections = false;
+
+// global lazy class population option
+DLLLOCAL bool jni_lazy_classes = false;
+
+// persistent bytecode cache directory
+DLLLOCAL std::string jni_bytecode_cache_dir;
+
+// maximum size of the identity cache for Java objects returned to Qore
+DLLLOCAL size_t jni_identity_cache_size = 0;
+
+// global option to pass binary values to untyped Java parameters as direct ByteBuffer objects
+DLLLOCAL bool jni_byte_buffers = false;
+
+// global option to convert hashes and lists to Java with a single call
+DLLLOCAL bool jni_marshal_data = true;
+
+// global option to pass hashes to Java as lazy proxies
+DLLLOCAL bool jni_lazy_hashes = false;
+
 static bool jni_init_failed = false;
 
 // module cmd type
@@ -96,6 +118,8 @@ static void qore_jni_mc_add_relative_classpath(const QoreString& arg, QoreProgra
 static void qore_jni_mc_define_pending_class(const QoreString& arg, QoreProgram* pgm, JniExternalProgramData* jpc);
 static void qore_jni_mc_define_class(const QoreString& arg, QoreProgram* pgm, JniExternalProgramData* jpc);
 static void qore_jni_mc_set_compat_types(const QoreString& arg, QoreProgram* pgm, JniExternalProgramData* jpc);
+static void qore_jni_mc_set_lazy_collections(const QoreString& arg, QoreProgram* pgm, JniExternalProgramData* jpc);
+static void qore_jni_mc_set_lazy_hashes(const QoreString& arg, QoreProgram* pgm, JniExternalProgramData* jpc);
 static void qore_jni_mc_set_property(const QoreString& arg, QoreProgram* pgm, JniExternalProgramData* jpc);
 
 // module cmds
@@ -107,6 +131,8 @@ static mcmap_t mcmap = {
     {"define-pending-class", qore_jni_mc_define_pending_class},
     {"define-class", qore_jni_mc_define_class},
     {"set-compat-types", qore_jni_mc_set_compat_types},
+    {"set-lazy-collections", qore_jni_mc_set_lazy_collections},
+    {"set-lazy-hashes", qore_jni_mc_set_lazy_hashes},
     {"set-property", qore_jni_mc_set_property},
 };
 
@@ -153,6 +179,51 @@ static QoreStringNode* jni_module_init() {
         }
     }
 
+    // the key cache is enabled before any hashes are converted
+    {
+        ValueHolder size(qore_get_module_option("jni", "key-cache"), nullptr);
+        int64 val = -1;
+        if (size) {
+            val = size->getAsBigInt();
+        } else {
+            // check QORE_JNI_KEY_CACHE environment variable
+            QoreString str;
+            if (!SystemEnvironment::get("QORE_JNI_KEY_CACHE", str)) {
+                val = strtoll(str.c_str(), nullptr, 10);
+            }
+        }
+        if (val > 0) {
+            QoreToJava::initKeyCache(val);
+        }
+    }
+
+    // the box cache range is read before the cache is populated in Globals::init()
+    {
+        ValueHolder high(qore_get_module_option("jni", "box-cache-high"), nullptr);
+        int64 val = -1;
+        bool set = false;
+        if (high) {
+            val = high->getAsBigInt();
+            set = true;
+        } else {
+            // check QORE_JNI_BOX_CACHE_HIGH environment variable
+            QoreString str;
+            if (!SystemEnvironment::get("QORE_JNI_BOX_CACHE_HIGH", str)) {
+                val = strtoll(str.c_str(), nullptr, 10);
+                set = true;
+            }
+        }
+        if (set) {
+            // a value below -128 disables the cache; the upper bound limits the memory used by the cache
+            if (val < -129) {
+                val = -129;
+            } else if (val > 65535) {
+                val = 65535;
+            }
+            jni_box_cache_high = (int)val;
+        }
+    }
+
     try {
         bootstrap = Globals::init();
     } catch (QoreStandardException &e) {
@@ -195,6 +266,94 @@ static QoreStringNode* jni_module_init() {
 
     tclist.push(jni_thread_cleanup, nullptr);
 
+    // lazy class population must be set before the class map is initialized
+    {
+        ValueHolder lazy(qore_get_module_option("jni", "lazy-classes"), nullptr);
+        if (lazy) {
+            jni_lazy_classes = lazy->getAsBool();
+        } else {
+            // check QORE_JNI_LAZY_CLASSES environment variable
+            QoreString val;
+            if (!SystemEnvironment::get("QORE_JNI_LAZY_CLASSES", val)) {
+                jni_lazy_classes = q_parse_bool(val.c_str());
+            }
+        }
+    }
+
+    // the ByteBuffer option is read before any values are converted
+    {
+        ValueHolder bb(qore_get_module_option("jni", "byte-buffers"), nullptr);
+        if (bb) {
+            jni_byte_buffers = bb->getAsBool();
+        } else {
+            // check QORE_JNI_BYTE_BUFFERS environment variable
+            QoreString val;
+            if (!SystemEnvironment::get("QORE_JNI_BYTE_BUFFERS", val)) {
+                jni_byte_buffers = q_parse_bool(val.c_str());
+            }
+        }
+    }
+
+    // the data marshalling option is read before any values are converted
+    {
+        ValueHolder md(qore_get_module_option("jni", "marshal-data"), nullptr);
+        if (md) {
+            jni_marshal_data = md->getAsBool();
+        } else {
+            // check QORE_JNI_MARSHAL_DATA environment variable
+            QoreString val;
+            if (!SystemEnvironment::get("QORE_JNI_MARSHAL_DATA", val)) {
+                jni_marshal_data = q_parse_bool(val.c_str());
+            }
+        }
+    }
+
+    // the lazy hash option is read before any values are converted
+    {
+        ValueHolder lh(qore_get_module_option("jni", "lazy-hashes"), nullptr);
+        if (lh) {
+            jni_lazy_hashes = lh->getAsBool();
+        } else {
+            // check QORE_JNI_LAZY_HASHES environment variable
+            QoreString val;
+            if (!SystemEnvironment::get("QORE_JNI_LAZY_HASHES", val)) {
+                jni_lazy_hashes = q_parse_bool(val.c_str());
+            }
+        }
+    }
+
+    // the bytecode cache directory is read before any classes are generated
+    {
+        ValueHolder dir(qore_get_module_option("jni", "bytecode-cache-dir"), nullptr);
+        if (dir && dir->getType() == NT_STRING) {
+            jni_bytecode_cache_dir = dir->get<const QoreStringNode>()->c_str();
+        } else {
+            // check QORE_JNI_BYTECODE_CACHE_DIR environment variable
+            QoreString val;
+            if (!SystemEnvironment::get("QORE_JNI_BYTECODE_CACHE_DIR", val)) {
+                jni_bytecode_cache_dir = val.c_str();
+            }
+        }
+    }
+
+    // the identity cache size is read before any Program data is created
+    {
+        ValueHolder size(qore_get_module_option("jni", "identity-cache"), nullptr);
+        int64 val = -1;
+        if (size) {
+            val = size->getAsBigInt();
+        } else {
+            // check QORE_JNI_IDENTITY_CACHE environment variable
+            QoreString str;
+            if (!SystemEnvironment::get("QORE_JNI_IDENTITY_CACHE", str)) {
+                val = strtoll(str.c_str(), nullptr, 10);
+            }
+        }
+        if (val > 0) {
+            jni_identity_cache_size = val;
+        }
+    }
+
     try {
         QoreProgram* pgm = Globals::createJavaContextProgram();
         // issue #4006: ensure there is a program context for initialization
@@ -219,6 +378,19 @@ static QoreStringNode* jni_module_init() {
         jni_compat_types = true;
     }
 
+    {
+        ValueHolder lazy(qore_get_module_option("jni", "lazy-collections"), &xsink);
+        if (lazy) {
+            jni_lazy_collections = lazy->getAsBool();
+        } else {
+            // check QORE_JNI_LAZY_COLLECTIONS environment variable
+            QoreString val;
+            if (!SystemEnvironment::get("QORE_JNI_LAZY_COLLECTIONS", val)) {
+                jni_lazy_collections = q_parse_bool(val.c_str());
+            }
+        }
+    }
+
     qore_set_module_option("jni", "jni-version", JNI_VERSION_1_8);
     //printd(5, "jni_module_init() jni module init done\n");
     return nullptr;
@@ -500,6 +672,23 @@ static void qore_jni_mc_set_compat_types(const QoreString& arg, QoreProgram* pgm
     jpc->overrideCompatTypes(compat_types);
 }
 
+static void qore_jni_mc_set_lazy_collections(const QoreString& arg, QoreProgram* pgm,
+        JniExternalProgramData* jpc) {
+    assert(pgm);
+    assert(pgm->checkFeature(QORE_JNI_MODULE_NAME));
+    assert(jpc);
+
+    jpc->overrideLazyCollections(q_parse_bool(arg.c_str()));
+}
+
+static void qore_jni_mc_set_lazy_hashes(const QoreString& arg, QoreProgram* pgm, JniExternalProgramData* jpc) {
+    assert(pgm);
+    assert(pgm->checkFeature(QORE_JNI_MODULE_NAME));
+    assert(jpc);
+
+    jpc->overrideLazyHashes(q_parse_bool(arg.c_str()));
+}
+
 static void qore_jni_mc_set_property(const QoreString& arg, QoreProgram* pgm, JniExternalProgramData* jpc) {
     assert(pgm);
     assert(pgm->checkFeature(QORE_JNI_MODULE_NAME));
@@ -2,4 +2,5 @@ package org.qore.jni.test;
 
 public class A {
     public int f() { return 1; }
+    public boolean calledThroughDynamicApi() { return StaticMethods.calledThroughDynamicApi(); }
 }
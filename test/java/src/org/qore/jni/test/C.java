@@ -3,4 +3,5 @@ package org.qore.jni.test;
 public class C extends B {
     public int f() { return 3; }
     public int m() { return 4; }
+    public boolean calledThroughDynamicApi() { throw new UnsupportedOperationException(); }
 }
@@ -1,5 +1,10 @@
 package org.qore.jni.test;
 
+import java.nio.ByteBuffer;
+import java.util.Map;
+
+import org.qore.jni.Hash;
+
 public class StaticMethods {
     private static int i;
 
@@ -57,6 +62,81 @@ public class StaticMethods {
     public static void useArray(Object[] a) {
     }
 
+    public static int[] copyIntArray(int[] a) {
+        return a.clone();
+    }
+
+    public static double[] copyDoubleArray(double[] a) {
+        return a.clone();
+    }
+
+    public static String describeBuffer(ByteBuffer buf) {
+        return (buf.isDirect() ? "direct" : "heap") + (buf.isReadOnly() ? "-ro:" : ":") + buf.remaining();
+    }
+
+    public static boolean isDirectBuffer(Object o) {
+        return o instanceof ByteBuffer && ((ByteBuffer)o).isDirect();
+    }
+
+    public static ByteBuffer makeDirectBuffer(byte[] b) {
+        ByteBuffer rv = ByteBuffer.allocateDirect(b.length);
+        rv.put(b);
+        rv.flip();
+        return rv;
+    }
+
+    public static Object echo(Object o) {
+        return o;
+    }
+
+    public static String getClassName(Object o) {
+        return o == null ? null : o.getClass().getName();
+    }
+
+    public static String[] getElementClassNames(Object o) {
+        Object[] a = (Object[])o;
+        String[] rv = new String[a.length];
+        for (int i = 0; i < a.length; ++i) {
+            rv[i] = getClassName(a[i]);
+        }
+        return rv;
+    }
+
+    public static Object[] mapLookup(Map<String, Object> m, String key) {
+        return new Object[] {m.get(key), m.containsKey(key), m.getOrDefault(key, "default")};
+    }
+
+    public static Map<String, Object> mapPut(Map<String, Object> m, String key, Object value) {
+        m.put(key, value);
+        return m;
+    }
+
+    public static Map<String, Object> mapClear(Map<String, Object> m) {
+        m.clear();
+        return m;
+    }
+
+    @SuppressWarnings("unchecked")
+    public static Map<String, Object> mapPutNested(Map<String, Object> m, String key, String nestedKey,
+            Object value) {
+        ((Map<String, Object>)m.get(key)).put(nestedKey, value);
+        return m;
+    }
+
+    public static Map<String, Object> mapSetElement(Map<String, Object> m, String key, int index, Object value) {
+        ((Object[])m.get(key))[index] = value;
+        return m;
+    }
+
+    public static Map<String, Object> mapRead(Map<String, Object> m, String key) {
+        m.get(key);
+        return m;
+    }
+
+    public static Object[] getHashFields(Hash h) {
+        return new Object[] {h.getLong("i"), h.getString("s"), h.getHash("h").getLong("x"), h.size()};
+    }
+
     public static Object conversions(String name) throws Exception {
         if (name.equals("method")) {
             return Object.class.getMethod("toString", new Class[] {});
@@ -75,4 +155,14 @@ public class StaticMethods {
         }
         return null;
     }
+
+    // returns true if the caller is org.qore.jni.QoreJavaDynamicApi, false if the method was called directly with JNI
+    public static boolean calledThroughDynamicApi() {
+        for (StackTraceElement e : new Throwable().getStackTrace()) {
+            if (e.getClassName().equals("org.qore.jni.QoreJavaDynamicApi")) {
+                return true;
+            }
+        }
+        return false;
+    }
 }